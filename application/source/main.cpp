@@ -33,7 +33,10 @@ public:
 class MainLayer : public Layer<MainLayer, Resources> {
 public:
   void setup(Handlers handlers) {
-    handlers.addInstanceHandler<EventA>(&MainLayer::onA);
+    handlers.addInstanceHandler<EventA>(
+        &MainLayer::onA,
+        HandlerMode::Passthrough
+    );
     handlers.addStaticHandler<EventB>(&MainLayer::onB);
     // ignore EventC
   }
@@ -57,7 +60,10 @@ public:
   void setup(Handlers handlers) {
     // ignore EventA
     handlers.addInstanceHandler<EventB>(&SecondLayer::onB);
-    handlers.addStaticHandler<EventC>(&SecondLayer::onC);
+    handlers.addStaticHandler<EventC>(
+        &SecondLayer::onC,
+        HandlerMode::Passthrough
+    );
   }
 
   void onB(Context<EventB> context) {
@@ -19,7 +19,10 @@ using std::filesystem::path;
 namespace matrix = solaris::matrix;
 
 void GameLayer::setup(Handlers handlers) {
-  handlers.addInstanceHandler<LoadEvent>(&GameLayer::onLoad);
+  handlers.addInstanceHandler<LoadEvent>(
+      &GameLayer::onLoad,
+      solaris::core::HandlerMode::Passthrough
+  );
   handlers.addInstanceHandler<RenderEvent>(&GameLayer::onRender);
 }
 
@@ -44,6 +47,11 @@ static Vertex triangle[] {
 };
 // clang-format on
 
+// folded at compile time, shows [-4, 4] on both axes
+static constexpr Matrix4f cameraProjection{
+    matrix::orthographic(-4.0f, 4.0f, -4.0f, 4.0f, -1.0f, 1.0f)
+};
+
 void GameLayer::onLoad(Context<LoadEvent> context) {
   cout << "Vendor:   " << glGetString(GL_VENDOR) << endl;
   cout << "Renderer: " << glGetString(GL_RENDERER) << endl;
@@ -117,11 +125,9 @@ void GameLayer::onRender(Context<RenderEvent> context) {
   auto y{std::cos(time)};
 
   m_CameraPosition = {x, y, 0.0};
-  auto scale{0.25f};
 
   auto projection{
-      matrix::translation<float>(-m_CameraPosition) *
-      matrix::scale<float>(scale)
+      cameraProjection * matrix::translation<float>(-m_CameraPosition)
   };
 
   glNamedBufferSubData(m_UBO, 0, sizeof(projection), &projection);
@@ -1,10 +1,12 @@
 #include "game.hpp"
 #include "graphics.hpp"
 #include "solaris/core/layer_stack.hpp"
+#include "solaris/core/static_bus.hpp"
 #include "solaris/framework/resources.hpp"
 #include "window.hpp"
 
 using solaris::core::LayerStack;
+using solaris::core::StaticBus;
 using solaris::framework::Resources;
 using solaris::framework::ResourceOwners;
 
@@ -30,7 +32,9 @@ int main() {
   LayerStack<Resources> layers;
   layers.addLayer<GameLayer>();
 
-  auto bus{layers.compileBus()};
+  auto bus{
+      layers.compileBus<StaticBus<Resources, LoadEvent, RenderEvent>>()
+  };
 
   bus.dispatch(LoadEvent(), resources);
 
@@ -2,38 +2,122 @@
 
 #include "dispatcher.hpp"
 #include <memory>
+#include <span>
+#include <stdexcept>
 #include <typeindex>
 #include <unordered_map>
 
 namespace solaris::core {
+/**
+ * Registration side of an event bus. Layers add their handlers through this
+ * interface, so the same layers can be compiled into any bus flavor.
+ */
 template <typename C>
-class Bus {
+class HandlerRegistry {
+protected:
+  using DispatcherFactory = std::unique_ptr<BaseDispatcher<C>> (*)();
+
+  template <typename E>
+  static std::unique_ptr<BaseDispatcher<C>> createDispatcher() {
+    return std::make_unique<Dispatcher<E, C>>();
+  }
+
+  /**
+   * Returns the dispatcher registered for the event type, creating it with
+   * `create` if the bus supports that, or nullptr if the bus can't carry
+   * the event type at all.
+   */
+  virtual BaseDispatcher<C> *
+  registryDispatcher(std::type_index event, DispatcherFactory create) = 0;
+
+private:
+  template <typename E>
+  Dispatcher<E, C> &registeredDispatcher() {
+    auto dispatcher{registryDispatcher(typeid(E), &createDispatcher<E>)};
+    if (!dispatcher)
+      throw std::invalid_argument("event type is not carried by this bus");
+    return static_cast<Dispatcher<E, C> &>(*dispatcher);
+  }
+
+public:
+  using Context = C;
+
+  virtual ~HandlerRegistry() = default;
+
+  /**
+   * Throws std::invalid_argument if the bus can't carry E, rather than
+   * letting the handler never run.
+   */
+  template <typename E>
+  void addHandler(
+      typename Dispatcher<E, C>::Handler &&handler,
+      HandlerMode mode = HandlerMode::Around
+  ) {
+    registeredDispatcher<E>().addHandler(std::move(handler), mode);
+  }
+
+  template <typename E>
+  void addBatchHandler(typename Dispatcher<E, C>::BatchHandler &&handler) {
+    registeredDispatcher<E>().addBatchHandler(std::move(handler));
+  }
+};
+
+template <typename C>
+class Bus : public HandlerRegistry<C> {
   std::unordered_map<std::type_index, std::unique_ptr<BaseDispatcher<C>>>
       m_Dispatchers{};
+  ThreadPool *m_ObserverPool{nullptr};
+
+protected:
+  BaseDispatcher<C> *registryDispatcher(
+      std::type_index event,
+      typename HandlerRegistry<C>::DispatcherFactory create
+  ) override {
+    auto [it, inserted]{m_Dispatchers.try_emplace(event)};
+    if (inserted) {
+      it->second = create();
+      it->second->setObserverPool(m_ObserverPool);
+    }
+    return it->second.get();
+  }
 
 public:
+  /** Observer handlers of every event type fan out on `pool`. */
+  void setObserverPool(ThreadPool *pool) {
+    m_ObserverPool = pool;
+    for (auto &[event, dispatcher] : m_Dispatchers)
+      dispatcher->setObserverPool(pool);
+  }
+
   template <typename E>
   Dispatcher<E, C> &getDispatcherFor() {
+    auto dispatcher{registryDispatcher(
+        typeid(E),
+        &HandlerRegistry<C>::template createDispatcher<E>
+    )};
+    return static_cast<Dispatcher<E, C> &>(*dispatcher);
+  }
+
+  /** Returns the dispatcher for E, or nullptr if nothing handles E. */
+  template <typename E>
+  Dispatcher<E, C> *findDispatcher() {
     if (auto it{m_Dispatchers.find(typeid(E))}; it != m_Dispatchers.end()) {
-      return dynamic_cast<Dispatcher<E, C> &>(*it->second);
+      return static_cast<Dispatcher<E, C> *>(it->second.get());
     }
-    auto [it, inserted]{
-        m_Dispatchers.insert({typeid(E), std::make_unique<Dispatcher<E, C>>()})
-    };
-
-    return dynamic_cast<Dispatcher<E, C> &>(*it->second);
+    return nullptr;
   }
 
   template <typename E>
-  void addHandler(typename Dispatcher<E, C>::Handler &&handler) {
-    getDispatcherFor<E>().addHandler(std::move(handler));
+  void dispatch(const E &event, C &context) {
+    if (auto dispatcher{findDispatcher<E>()}) {
+      dispatcher->dispatch(event, context);
+    }
   }
 
   template <typename E>
-  void dispatch(const E &event, C &context) {
-    if (auto it{m_Dispatchers.find(typeid(E))}; it != m_Dispatchers.end()) {
-      auto &dispatcher{dynamic_cast<Dispatcher<E, C> &>(*it->second)};
-      dispatcher.dispatch(event, context);
+  void dispatchBatch(std::span<const E> events, C &context) {
+    if (auto dispatcher{findDispatcher<E>()}) {
+      dispatcher->dispatchBatch(events, context);
     }
   }
 };
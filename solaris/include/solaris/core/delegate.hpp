@@ -0,0 +1,159 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace solaris::core {
+template <typename Signature>
+class Delegate;
+
+/**
+ * Fixed-size callable: a thunk plus a few bytes of inline state.
+ *
+ * Holds a free function, an object paired with a member function, or a small
+ * trivially copyable callable such as a lambda capturing a pointer, without
+ * allocating, so delegates can be stored back to back in a vector and
+ * invoked with a single indirect call. Other callables, e.g. lambdas that
+ * capture a std::string, are moved to the heap and owned by the delegate,
+ * like std::function does; they must be copy constructible.
+ */
+template <typename R, typename... Args>
+class Delegate<R(Args...)> {
+  struct Probe {
+    void method();
+  };
+
+public:
+  static constexpr size_t StorageSize{
+      sizeof(void *) + sizeof(void (Probe::*)())
+  };
+
+private:
+  using Thunk = R (*)(const Delegate &, Args...);
+  /** Copies the owned callable of `source`, or destroys it if no `target`. */
+  using Manager = void (*)(const Delegate &source, Delegate *target);
+
+  alignas(void *) std::byte m_Storage[StorageSize]{};
+  Thunk m_Thunk{nullptr};
+  Manager m_Manage{nullptr};
+
+  template <typename F>
+  static constexpr bool StoredInline{
+      sizeof(F) <= StorageSize && alignof(F) <= alignof(void *) &&
+      std::is_trivially_copyable_v<F>
+  };
+
+  template <typename F>
+  F &stored() const {
+    auto storage{const_cast<std::byte *>(m_Storage)};
+    return *std::launder(reinterpret_cast<F *>(storage));
+  }
+
+  template <typename F>
+  void store(F value) {
+    static_assert(sizeof(F) <= StorageSize, "callable too large for delegate");
+    static_assert(alignof(F) <= alignof(void *));
+    static_assert(std::is_trivially_copyable_v<F>);
+    new (m_Storage) F(value);
+  }
+
+  template <typename T>
+  struct BoundMethod {
+    T *Object;
+    R (T::*Method)(Args...);
+  };
+
+public:
+  Delegate() = default;
+
+  Delegate(const Delegate &other)
+      : m_Thunk{other.m_Thunk}, m_Manage{other.m_Manage} {
+    if (m_Manage)
+      m_Manage(other, this);
+    else
+      std::memcpy(m_Storage, other.m_Storage, StorageSize);
+  }
+
+  Delegate(Delegate &&other) noexcept
+      : m_Thunk{std::exchange(other.m_Thunk, nullptr)},
+        m_Manage{std::exchange(other.m_Manage, nullptr)} {
+    std::memcpy(m_Storage, other.m_Storage, StorageSize);
+  }
+
+  Delegate &operator=(Delegate other) noexcept {
+    std::swap(m_Storage, other.m_Storage);
+    std::swap(m_Thunk, other.m_Thunk);
+    std::swap(m_Manage, other.m_Manage);
+    return *this;
+  }
+
+  ~Delegate() {
+    if (m_Manage)
+      m_Manage(*this, nullptr);
+  }
+
+  Delegate(R (*function)(Args...)) {
+    store(function);
+    m_Thunk = [](const Delegate &self, Args... args) -> R {
+      return self.stored<R (*)(Args...)>()(std::forward<Args>(args)...);
+    };
+  }
+
+  template <typename T>
+  Delegate(T &object, R (T::*method)(Args...)) {
+    store(BoundMethod<T>{&object, method});
+    m_Thunk = [](const Delegate &self, Args... args) -> R {
+      auto &bound{self.stored<BoundMethod<T>>()};
+      return (bound.Object->*bound.Method)(std::forward<Args>(args)...);
+    };
+  }
+
+  template <typename F>
+    requires(!std::same_as<std::remove_cvref_t<F>, Delegate> &&
+             std::is_invocable_r_v<R, F &, Args...>)
+  Delegate(F callable) {
+    if constexpr (StoredInline<F>) {
+      store(callable);
+      m_Thunk = [](const Delegate &self, Args... args) -> R {
+        return self.stored<F>()(std::forward<Args>(args)...);
+      };
+    } else {
+      static_assert(std::is_copy_constructible_v<F>);
+      store(new F(std::move(callable)));
+      m_Thunk = [](const Delegate &self, Args... args) -> R {
+        return (*self.stored<F *>())(std::forward<Args>(args)...);
+      };
+      m_Manage = [](const Delegate &source, Delegate *target) {
+        if (target)
+          target->store(new F(*source.stored<F *>()));
+        else
+          delete source.stored<F *>();
+      };
+    }
+  }
+
+  /**
+   * Binds a member function known at compile time, so the thunk calls it
+   * directly instead of through a member function pointer.
+   */
+  template <auto Method, typename T>
+  static Delegate bind(T &object) {
+    Delegate delegate{};
+    delegate.store(&object);
+    delegate.m_Thunk = [](const Delegate &self, Args... args) -> R {
+      return (self.stored<T *>()->*Method)(std::forward<Args>(args)...);
+    };
+    return delegate;
+  }
+
+  R operator()(Args... args) const {
+    return m_Thunk(*this, std::forward<Args>(args)...);
+  }
+
+  explicit operator bool() const { return m_Thunk != nullptr; }
+};
+} // namespace solaris::core
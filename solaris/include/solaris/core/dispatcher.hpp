@@ -1,52 +1,159 @@
 #pragma once
 
-#include <functional>
+#include "delegate.hpp"
+#include "thread_pool.hpp"
+#include <span>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace solaris::core {
+/** How a handler takes part in its dispatcher's handler chain. */
+enum class HandlerMode {
+  /**
+   * The handler calls `next()` and may do more work after it returns, so
+   * the rest of the chain runs nested inside it.
+   */
+  Around,
+  /**
+   * The handler does no work after `next()`. Calling `next()` only marks the
+   * chain to continue, and the dispatcher runs the following handler in a
+   * flat loop once this one has returned.
+   */
+  Passthrough,
+  /**
+   * The handler only reacts to the event and has no place in the chain;
+   * `next()` does nothing. Consecutive observers run together, in parallel
+   * when the dispatcher has an observer pool, and the chain continues once
+   * all of them have returned. Observers share the context across threads,
+   * so they should only touch it through borrows or other synchronization.
+   */
+  Observer,
+};
+
 template <typename C>
 class BaseDispatcher {
+protected:
+  ThreadPool *m_ObserverPool{nullptr};
+
 public:
   virtual ~BaseDispatcher() {}
+
+  /** Pool observer handlers fan out on; without one they run in turn. */
+  void setObserverPool(ThreadPool *pool) { m_ObserverPool = pool; }
 };
 
 template <typename E, typename C>
 class Dispatcher : public BaseDispatcher<C> {
 public:
   class Context;
+  class Batch;
 
-  using Handler = std::function<void(Context)>;
+  using Handler = Delegate<void(Context)>;
+  using BatchHandler = Delegate<void(Batch)>;
 
   class Context {
-    using Iterator = typename std::vector<Handler>::iterator;
+    friend class Dispatcher;
 
-    const E &m_Event;
-    Iterator m_Iter;
-    Iterator m_End;
-    C &m_Context;
+    struct Link {
+      Handler Callback;
+      HandlerMode Mode;
+    };
 
-  public:
-    Context(const E &event, Iterator iter, Iterator end, C &context)
-        : m_Event{event}, m_Iter{iter}, m_End{end}, m_Context{context} {}
+    struct Chain {
+      const E &Event;
+      C &Context;
+      const Link *End;
+      ThreadPool *Pool;
+      // the furthest link the event got to, End if it passed every handler
+      const Link **Furthest;
+    };
+
+    const Chain *m_Chain;
+    const Link *m_Next;
+    // set for pass-through handlers, next() only flags the chain to continue
+    bool *m_Continue;
+
+    Context(const Chain &chain, const Link *next, bool *proceed)
+        : m_Chain{&chain}, m_Next{next}, m_Continue{proceed} {}
+
+    /** Runs the observers starting at `first`, returns the link after. */
+    static const Link *observe(const Chain &chain, const Link *first) {
+      auto last{first};
+      while (last != chain.End && last->Mode == HandlerMode::Observer)
+        ++last;
 
+      auto count{size_t(last - first)};
+      if (chain.Pool && count > 1) {
+        chain.Pool->parallelFor(count, [&chain, first](size_t index) {
+          first[index].Callback(Context{chain, nullptr, nullptr});
+        });
+      } else {
+        for (auto link{first}; link != last; ++link)
+          link->Callback(Context{chain, nullptr, nullptr});
+      }
+      return last;
+    }
+
+    static void run(const Chain &chain, const Link *link) {
+      while (true) {
+        if (link > *chain.Furthest)
+          *chain.Furthest = link;
+        if (link == chain.End)
+          return;
+        switch (link->Mode) {
+        case HandlerMode::Around:
+          link->Callback(Context{chain, link + 1, nullptr});
+          return;
+        case HandlerMode::Passthrough: {
+          bool proceed{false};
+          link->Callback(Context{chain, link + 1, &proceed});
+          if (!proceed)
+            return;
+          ++link;
+          break;
+        }
+        case HandlerMode::Observer:
+          link = observe(chain, link);
+          break;
+        }
+      }
+    }
+
+  public:
     void next() {
-      if (m_Iter == m_End)
+      if (m_Continue) {
+        *m_Continue = true;
         return;
+      }
 
-      auto &handler{*m_Iter};
-
-      Context next{
-          m_Event,
-          m_Iter + 1,
-          m_End,
-          m_Context,
-      };
-      m_Iter = m_End;
-      handler(next);
+      if (auto link{std::exchange(m_Next, nullptr)})
+        run(*m_Chain, link);
     }
 
-    const E &event() const { return m_Event; }
+    const E &event() const { return m_Chain->Event; }
+
+    C *operator->() { return &m_Chain->Context; }
+
+    C &operator*() { return m_Chain->Context; }
+  };
+
+  /**
+   * A run of events of the same type, handed to batch handlers in one call.
+   */
+  class Batch {
+    std::span<const E> m_Events;
+    C &m_Context;
+
+  public:
+    Batch(std::span<const E> events, C &context)
+        : m_Events{events}, m_Context{context} {}
+
+    std::span<const E> events() const { return m_Events; }
+
+    auto begin() const { return m_Events.begin(); }
+    auto end() const { return m_Events.end(); }
+    size_t size() const { return m_Events.size(); }
 
     C *operator->() { return &m_Context; }
 
@@ -54,21 +161,99 @@ public:
   };
 
 private:
-  std::vector<Handler> m_Handlers{};
+  struct BatchLink {
+    BatchHandler Callback;
+    // the number of handlers in the chain before it
+    size_t Position;
+  };
+
+  std::vector<typename Context::Link> m_Handlers{};
+  std::vector<BatchLink> m_BatchHandlers{};
+
+  /** Returns how many handlers of the chain the event got past. */
+  size_t runChain(const E &event, C &context) {
+    const typename Context::Link *furthest{m_Handlers.data()};
+    typename Context::Chain chain{
+        .Event = event,
+        .Context = context,
+        .End = m_Handlers.data() + m_Handlers.size(),
+        .Pool = this->m_ObserverPool,
+        .Furthest = &furthest,
+    };
+    Context::run(chain, m_Handlers.data());
+    return size_t(furthest - m_Handlers.data());
+  }
 
 public:
-  void addHandler(Handler &&handler) {
-    m_Handlers.push_back(std::move(handler));
+  void addHandler(Handler &&handler, HandlerMode mode = HandlerMode::Around) {
+    m_Handlers.push_back({.Callback = std::move(handler), .Mode = mode});
+  }
+
+  /**
+   * Adds a handler for runs of events, placed in the chain after the
+   * handlers added so far. It runs once the events went through the chain,
+   * and only sees those that reached its place: events consumed by an
+   * earlier handler, which did not call `next()`, are left out, just as
+   * they are hidden from the handlers after it.
+   */
+  void addBatchHandler(BatchHandler &&handler) {
+    m_BatchHandlers.push_back(
+        {.Callback = std::move(handler), .Position = m_Handlers.size()}
+    );
   }
 
+  [[nodiscard]] bool hasBatchHandlers() const {
+    return !m_BatchHandlers.empty();
+  }
+
+  /**
+   * The event runs through the handler chain, then the batch handlers it
+   * reached see it as a batch of one.
+   */
   void dispatch(const E &event, C &context) {
-    Context contextWrapper{
-        event,
-        m_Handlers.begin(),
-        m_Handlers.end(),
-        context,
-    };
-    contextWrapper.next();
+    auto reached{runChain(event, context)};
+    for (auto &handler : m_BatchHandlers) {
+      if (handler.Position <= reached)
+        handler.Callback(Batch{std::span{&event, 1}, context});
+    }
+  }
+
+  /**
+   * Each event runs through the handler chain in order, then each batch
+   * handler receives the events that reached it, as few consecutive runs
+   * as possible; a single run unless the chain consumed some of them.
+   */
+  void dispatchBatch(std::span<const E> events, C &context) {
+    if (m_Handlers.empty()) {
+      for (auto &handler : m_BatchHandlers)
+        handler.Callback(Batch{events, context});
+      return;
+    }
+    if (m_BatchHandlers.empty()) {
+      for (const auto &event : events)
+        runChain(event, context);
+      return;
+    }
+
+    std::vector<size_t> reached;
+    reached.reserve(events.size());
+    for (const auto &event : events)
+      reached.push_back(runChain(event, context));
+
+    for (auto &handler : m_BatchHandlers) {
+      size_t begin{0};
+      while (begin < events.size()) {
+        if (reached[begin] < handler.Position) {
+          ++begin;
+          continue;
+        }
+        auto end{begin + 1};
+        while (end < events.size() && reached[end] >= handler.Position)
+          ++end;
+        handler.Callback(Batch{events.subspan(begin, end - begin), context});
+        begin = end;
+      }
+    }
   }
 };
 } // namespace solaris::core
@@ -12,23 +12,47 @@ public:
 
 template <typename T, typename C>
 class LayerHandlers {
-  Bus<C> &m_Bus;
+  HandlerRegistry<C> &m_Bus;
   T &m_Layer;
 
 public:
-  LayerHandlers(Bus<C> &bus, T &layer) : m_Bus{bus}, m_Layer{layer} {}
+  LayerHandlers(HandlerRegistry<C> &bus, T &layer)
+      : m_Bus{bus}, m_Layer{layer} {}
 
   template <typename E>
-  void addInstanceHandler(void (T::*handler)(typename Dispatcher<E, C>::Context)
+  void addInstanceHandler(
+      void (T::*handler)(typename Dispatcher<E, C>::Context),
+      HandlerMode mode = HandlerMode::Around
   ) {
-    T& layer{m_Layer};
-    m_Bus.template addHandler<E>([&layer, handler=handler](typename Dispatcher<E, C>::Context context
-                                 ) { (layer.*handler)(std::move(context)); });
+    m_Bus.template addHandler<E>({m_Layer, handler}, mode);
+  }
+
+  /** Binds the handler at compile time, so dispatch calls it directly. */
+  template <typename E, void (T::*Handler)(typename Dispatcher<E, C>::Context)>
+  void addInstanceHandler(HandlerMode mode = HandlerMode::Around) {
+    using Bound = typename Dispatcher<E, C>::Handler;
+    m_Bus.template addHandler<E>(Bound::template bind<Handler>(m_Layer), mode);
   }
 
   template <typename E>
-  void addStaticHandler(void (*handler)(typename Dispatcher<E, C>::Context)) {
-    m_Bus.template addHandler<E>(handler);
+  void addStaticHandler(
+      void (*handler)(typename Dispatcher<E, C>::Context),
+      HandlerMode mode = HandlerMode::Around
+  ) {
+    m_Bus.template addHandler<E>(handler, mode);
+  }
+
+  template <typename E>
+  void
+  addInstanceBatchHandler(void (T::*handler)(typename Dispatcher<E, C>::Batch)
+  ) {
+    m_Bus.template addBatchHandler<E>({m_Layer, handler});
+  }
+
+  template <typename E>
+  void addStaticBatchHandler(void (*handler)(typename Dispatcher<E, C>::Batch)
+  ) {
+    m_Bus.template addBatchHandler<E>(handler);
   }
 };
 
@@ -38,6 +62,9 @@ public:
   template <typename E>
   using Context = typename Dispatcher<E, C>::Context;
 
+  template <typename E>
+  using Batch = typename Dispatcher<E, C>::Batch;
+
   using Handlers = LayerHandlers<T, C>;
 
   virtual ~Layer() {}
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "bus.hpp"
 #include "layer.hpp"
+#include <concepts>
 #include <memory>
 #include <vector>
 
@@ -12,10 +14,10 @@ class LayerStack {
 
   struct ManagedLayer {
     std::unique_ptr<BaseLayer<C>> m_Layer;
-    void (*m_Setup)(Bus<C> &, BaseLayer<C> &);
+    void (*m_Setup)(HandlerRegistry<C> &, BaseLayer<C> &);
 
     template <typename T>
-    static void setupLayer(Bus<C> &bus, BaseLayer<C> &layer) {
+    static void setupLayer(HandlerRegistry<C> &bus, BaseLayer<C> &layer) {
       T &castLayer{dynamic_cast<T &>(layer)};
       castLayer.setup(LayerHandlers<T, C>{bus, castLayer});
     }
@@ -24,7 +26,7 @@ class LayerStack {
     ManagedLayer(std::unique_ptr<T> layer)
         : m_Layer{std::move(layer)}, m_Setup{&setupLayer<T>} {}
 
-    void setup(Bus<C> &bus) { m_Setup(bus, *m_Layer); }
+    void setup(HandlerRegistry<C> &bus) { m_Setup(bus, *m_Layer); }
   };
 
   std::vector<ManagedLayer> m_Layers{};
@@ -35,8 +37,14 @@ public:
     m_Layers.emplace_back(std::make_unique<T>(std::forward<Args>(args)...));
   }
 
-  Bus<C> compileBus() {
-    Bus<C> bus{};
+  /**
+   * Wires every layer's handlers into a new bus, in layer order. B selects
+   * the bus flavor, e.g. `StaticBus<C, Events...>` for a fixed set of events.
+   */
+  template <typename B = Bus<C>>
+    requires std::derived_from<B, HandlerRegistry<C>>
+  B compileBus() {
+    B bus{};
     for (auto &layer : m_Layers) {
       layer.setup(bus);
     }
@@ -1,68 +1,656 @@
 #pragma once
 
 #include "bus.hpp"
-#include <any>
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <new>
 #include <optional>
-#include <queue>
-#include <stack>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace solaris::core {
-template <typename C>
+namespace impl {
+/**
+ * Append-only byte arena that a single producer thread writes events into.
+ *
+ * The producer holds one reference while the segment is its current target,
+ * and every record allocated from it holds another. The segment frees itself
+ * once the producer has moved on and the last record has been consumed.
+ */
+class alignas(std::max_align_t) QueueSegment {
+  std::atomic<size_t> m_References{1};
+  size_t m_Used{0};
+  size_t m_Capacity;
+
+  explicit QueueSegment(size_t capacity) : m_Capacity{capacity} {}
+
+  std::byte *data() { return reinterpret_cast<std::byte *>(this + 1); }
+
+public:
+  static constexpr size_t DefaultCapacity{16 * 1024};
+
+  QueueSegment(const QueueSegment &) = delete;
+  QueueSegment &operator=(const QueueSegment &) = delete;
+
+  static QueueSegment *create(size_t capacity) {
+    void *memory{::operator new(sizeof(QueueSegment) + capacity)};
+    return new (memory) QueueSegment(capacity);
+  }
+
+  /** Reserves a block in the arena, or returns nullptr if it doesn't fit. */
+  void *allocate(size_t size, size_t alignment) {
+    auto base{reinterpret_cast<uintptr_t>(data())};
+    auto aligned{(base + m_Used + alignment - 1) & ~(alignment - 1)};
+    auto offset{aligned - base};
+    if (offset + size > m_Capacity)
+      return nullptr;
+
+    m_Used = offset + size;
+    m_References.fetch_add(1, std::memory_order_relaxed);
+    return data() + offset;
+  }
+
+  void release() {
+    if (m_References.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      this->~QueueSegment();
+      ::operator delete(this);
+    }
+  }
+};
+
+/**
+ * The segments the calling thread is currently appending to, keyed by queue.
+ * Every queue the thread produces into keeps its segment, however many there
+ * are; entries of destroyed queues are dropped whenever the thread starts
+ * producing into a new queue.
+ */
+class ProducerSegments {
+  struct Entry {
+    std::weak_ptr<const void> Queue{};
+    QueueSegment *Segment{nullptr};
+  };
+
+  std::unordered_map<uint64_t, Entry> m_Entries{};
+
+  ProducerSegments() = default;
+
+public:
+  ProducerSegments(const ProducerSegments &) = delete;
+  ProducerSegments &operator=(const ProducerSegments &) = delete;
+
+  ~ProducerSegments() {
+    for (auto &[_, entry] : m_Entries) {
+      if (entry.Segment)
+        entry.Segment->release();
+    }
+  }
+
+  static ProducerSegments &local() {
+    thread_local ProducerSegments segments{};
+    return segments;
+  }
+
+  /** `alive` is owned by the queue, so that its entry expires with it. */
+  QueueSegment *&
+  segmentFor(uint64_t queueID, const std::shared_ptr<const void> &alive) {
+    if (auto it{m_Entries.find(queueID)}; it != m_Entries.end())
+      return it->second.Segment;
+
+    std::erase_if(m_Entries, [](const auto &entry) {
+      const auto &[_, expired]{entry};
+      if (!expired.Queue.expired())
+        return false;
+      if (expired.Segment)
+        expired.Segment->release();
+      return true;
+    });
+    auto [it, _]{m_Entries.emplace(queueID, Entry{.Queue = alive})};
+    return it->second.Segment;
+  }
+
+  static uint64_t nextQueueID() {
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
+  }
+};
+
+inline size_t nextEventTypeID() {
+  static std::atomic<size_t> counter{0};
+  return counter++;
+}
+
+/** Dense per-type index, used to look up per-type queue settings. */
+template <typename T>
+size_t eventTypeID() {
+  static const size_t id{nextEventTypeID()};
+  return id;
+}
+} // namespace impl
+
+/** How `Queue::dispatchBatchedOn` groups the events it drains. */
+enum class BatchOrder {
+  /**
+   * Every event of a type is dispatched in one group. Groups follow the
+   * order in which each type first appeared; order within a type is kept.
+   */
+  GroupByType,
+  /**
+   * Only consecutive events of the same type are grouped, so the global
+   * order of events is kept.
+   */
+  Preserve,
+};
+
+/**
+ * Multi-producer, single-consumer event queue.
+ *
+ * Producers construct events in place inside a per-thread arena segment and
+ * publish each one with a compare-and-swap on a shared list head, so an event
+ * is visible to the consumer as soon as `enqueue` returns and producers never
+ * need to flush. The consumer takes everything published so far with one
+ * atomic exchange and dispatches it in order of publication. Only one thread
+ * may call `dispatchOn` at a time.
+ *
+ * Event types can be given a coalescing policy (`coalesceLatest`,
+ * `coalesceWith`, `dedupeBy`), applied at enqueue time so that bursts of
+ * high-frequency events are dispatched once. A coalesced event is dispatched
+ * at the position of the first event it absorbed. Policies must be set up
+ * before events of that type are enqueued.
+ *
+ * B is the bus flavor the events are dispatched on, e.g.
+ * `StaticBus<C, Events...>`; it must be able to dispatch every event type
+ * that is enqueued.
+ */
+template <typename C, typename B = Bus<C>>
+  requires std::derived_from<B, HandlerRegistry<C>>
 class Queue {
-  class QueuedEvent {
-    std::any m_Event;
-    void (*m_Dispatch)(Bus<C> &, C &, const std::any &);
-
-    template <typename T>
-    static void dispatcher(Bus<C> &bus, C &context, const std::any &event) {
-      if (const T * castEvent{std::any_cast<T>(&event)}) {
-        bus.dispatch(*castEvent, context);
+  struct Record;
+
+  struct EventOperations {
+    void (*Dispatch)(B &, C &, void *);
+    void (*DispatchBatch)(B &, C &, Record *const *, size_t);
+    void (*Destroy)(void *);
+  };
+
+  struct Record {
+    Record *Next;
+    impl::QueueSegment *Segment;
+    const EventOperations *Operations;
+    void *Event;
+
+    void destroy() {
+      Operations->Destroy(Event);
+      Segment->release();
+    }
+  };
+
+  class BaseCoalescer {
+  public:
+    virtual ~BaseCoalescer() = default;
+  };
+
+  /** Folds every pending event of T into one. */
+  template <typename T>
+  class MergingCoalescer final : public BaseCoalescer {
+    std::mutex m_Lock{};
+    std::optional<T> m_Pending{};
+    std::function<void(T &, T &&)> m_Merge;
+
+  public:
+    explicit MergingCoalescer(std::function<void(T &, T &&)> merge)
+        : m_Merge{std::move(merge)} {}
+
+    /** Returns true if nothing was pending, so a placeholder is needed. */
+    bool offer(T &&event) {
+      std::lock_guard lockGuard{m_Lock};
+      if (m_Pending) {
+        m_Merge(*m_Pending, std::move(event));
+        return false;
       }
+      m_Pending.emplace(std::move(event));
+      return true;
     }
 
-    QueuedEvent(std::any &&event, typeof(m_Dispatch) dispatch)
-        : m_Event{std::move(event)}, m_Dispatch{dispatch} {}
+    std::optional<T> take() {
+      std::lock_guard lockGuard{m_Lock};
+      return std::exchange(m_Pending, std::nullopt);
+    }
+  };
+
+  /** Drops events of T whose key is already pending. */
+  template <typename T, typename K>
+  class KeyedCoalescer final : public BaseCoalescer {
+    std::mutex m_Lock{};
+    std::unordered_set<K> m_Pending{};
+    std::function<K(const T &)> m_Key;
 
   public:
-    template <typename T>
-    static QueuedEvent newFor(std::any &&event) {
-      return QueuedEvent{std::move(event), &QueuedEvent::dispatcher<T>};
+    explicit KeyedCoalescer(std::function<K(const T &)> key)
+        : m_Key{std::move(key)} {}
+
+    /** Returns true if the event's key was not pending yet. */
+    bool offer(const T &event) {
+      std::lock_guard lockGuard{m_Lock};
+      return m_Pending.insert(m_Key(event)).second;
+    }
+
+    void release(const T &event) {
+      std::lock_guard lockGuard{m_Lock};
+      m_Pending.erase(m_Key(event));
     }
+  };
+
+  template <typename T, typename K>
+  struct Keyed {
+    KeyedCoalescer<T, K> *Owner;
+    T Event;
+    bool Claimed{false};
+  };
+
+  /** Placeholder at the position of the first event a coalescer merged. */
+  template <typename T>
+  struct Merged {
+    MergingCoalescer<T> *Owner;
+    bool Taken{false};
+  };
+
+  struct Coalescing {
+    std::unique_ptr<BaseCoalescer> Coalescer;
+    void (*Enqueue)(Queue &, BaseCoalescer &, void *);
+  };
+
+  template <typename T>
+  static T *eventOf(void *payload) {
+    return static_cast<T *>(payload);
+  }
+
+  /** Releases the event's key so that a new one can be enqueued. */
+  template <typename T, typename K>
+  static T *claimKeyed(void *payload) {
+    auto &keyed{*static_cast<Keyed<T, K> *>(payload)};
+    keyed.Owner->release(keyed.Event);
+    keyed.Claimed = true;
+    return &keyed.Event;
+  }
+
+  /**
+   * Releases the key of an event destroyed without being dispatched, e.g.
+   * after a handler threw, so that events with that key are accepted again.
+   */
+  template <typename T, typename K>
+  static void keyedDestructor(void *payload) {
+    auto &keyed{*static_cast<Keyed<T, K> *>(payload)};
+    if (!keyed.Claimed)
+      keyed.Owner->release(keyed.Event);
+    keyed.~Keyed();
+  }
+
+  template <typename T, auto Claim>
+  static void dispatcher(B &bus, C &context, void *payload) {
+    bus.dispatch(*Claim(payload), context);
+  }
+
+  template <typename T, auto Claim>
+  static void batchDispatcher(
+      B &bus,
+      C &context,
+      Record *const *records,
+      size_t count
+  ) {
+    auto dispatcher{bus.template findDispatcher<T>()};
+    if (!dispatcher)
+      return;
+
+    if constexpr (std::is_move_constructible_v<T>) {
+      if (dispatcher->hasBatchHandlers() && count > 1) {
+        // batch handlers need the events side by side
+        std::vector<T> events;
+        events.reserve(count);
+        for (size_t i{0}; i < count; ++i)
+          events.push_back(std::move(*Claim(records[i]->Event)));
 
-    void dispatch(Bus<C> &bus, C &context) {
-      m_Dispatch(bus, context, m_Event);
+        dispatcher->dispatchBatch(std::span<const T>{events}, context);
+        return;
+      }
     }
+
+    for (size_t i{0}; i < count; ++i)
+      dispatcher->dispatch(*Claim(records[i]->Event), context);
+  }
+
+  template <typename T>
+  static void mergedDispatcher(B &bus, C &context, void *payload) {
+    auto &merged{*static_cast<Merged<T> *>(payload)};
+    merged.Taken = true;
+    if (auto event{merged.Owner->take()})
+      bus.dispatch(*event, context);
+  }
+
+  template <typename T>
+  static void mergedBatchDispatcher(
+      B &bus,
+      C &context,
+      Record *const *records,
+      size_t count
+  ) {
+    for (size_t i{0}; i < count; ++i)
+      mergedDispatcher<T>(bus, context, records[i]->Event);
+  }
+
+  template <typename T>
+  static void destructor(void *event) {
+    static_cast<T *>(event)->~T();
+  }
+
+  /** Drops the merged event of a placeholder destroyed undispatched. */
+  template <typename T>
+  static void mergedDestructor(void *payload) {
+    auto &merged{*static_cast<Merged<T> *>(payload)};
+    if (!merged.Taken)
+      merged.Owner->take();
+    merged.~Merged();
+  }
+
+  template <typename T>
+  static constexpr EventOperations OperationsFor{
+      .Dispatch = &Queue::dispatcher<T, &Queue::eventOf<T>>,
+      .DispatchBatch = &Queue::batchDispatcher<T, &Queue::eventOf<T>>,
+      .Destroy = &Queue::destructor<T>,
+  };
+
+  template <typename T>
+  static constexpr EventOperations MergedOperationsFor{
+      .Dispatch = &Queue::mergedDispatcher<T>,
+      .DispatchBatch = &Queue::mergedBatchDispatcher<T>,
+      .Destroy = &Queue::mergedDestructor<T>,
   };
 
-  std::queue<QueuedEvent> m_Events{};
-  std::mutex m_Lock{};
+  template <typename T, typename K>
+  static constexpr EventOperations KeyedOperationsFor{
+      .Dispatch = &Queue::dispatcher<T, &Queue::claimKeyed<T, K>>,
+      .DispatchBatch = &Queue::batchDispatcher<T, &Queue::claimKeyed<T, K>>,
+      .Destroy = &Queue::keyedDestructor<T, K>,
+  };
+
+  template <typename T>
+  static void enqueueMerged(Queue &queue, BaseCoalescer &base, void *event) {
+    auto &coalescer{static_cast<MergingCoalescer<T> &>(base)};
+    if (coalescer.offer(std::move(*static_cast<T *>(event)))) {
+      queue.emplace<Merged<T>>(&MergedOperationsFor<T>, &coalescer);
+    }
+  }
+
+  template <typename T, typename K>
+  static void enqueueKeyed(Queue &queue, BaseCoalescer &base, void *event) {
+    auto &coalescer{static_cast<KeyedCoalescer<T, K> &>(base)};
+    auto &value{*static_cast<T *>(event)};
+    if (coalescer.offer(value)) {
+      queue.emplace<Keyed<T, K>>(
+          &KeyedOperationsFor<T, K>,
+          &coalescer,
+          std::move(value)
+      );
+    }
+  }
+
+  std::atomic<Record *> m_Head{nullptr};
+  // records taken from m_Head but not dispatched yet, oldest first
+  Record *m_Pending{nullptr};
+  uint64_t m_ID{impl::ProducerSegments::nextQueueID()};
+  std::shared_ptr<const void> m_Alive{std::make_shared<bool>()};
+  // indexed by impl::eventTypeID, only written while setting up policies
+  std::vector<Coalescing> m_Coalescing{};
+
+  template <typename T>
+  static constexpr size_t eventOffset() {
+    return (sizeof(Record) + alignof(T) - 1) & ~(alignof(T) - 1);
+  }
+
+  template <typename T>
+  Record *allocateRecord() {
+    constexpr size_t size{eventOffset<T>() + sizeof(T)};
+    constexpr size_t alignment{std::max(alignof(Record), alignof(T))};
+
+    auto &segment{
+        impl::ProducerSegments::local().segmentFor(m_ID, m_Alive)
+    };
+    void *memory{segment ? segment->allocate(size, alignment) : nullptr};
+    impl::QueueSegment *owner{segment};
+
+    if (!memory) {
+      if (size + alignment > impl::QueueSegment::DefaultCapacity) {
+        // too large for a shared segment, give it one of its own
+        owner = impl::QueueSegment::create(size + alignment);
+        memory = owner->allocate(size, alignment);
+        owner->release();
+      } else {
+        if (segment)
+          segment->release();
+        segment =
+            impl::QueueSegment::create(impl::QueueSegment::DefaultCapacity);
+        owner = segment;
+        memory = owner->allocate(size, alignment);
+      }
+    }
+
+    return new (memory) Record{
+        .Next = nullptr,
+        .Segment = owner,
+        .Operations = nullptr,
+        .Event = static_cast<std::byte *>(memory) + eventOffset<T>(),
+    };
+  }
+
+  template <typename T, typename... Args>
+  void emplace(const EventOperations *operations, Args &&...args) {
+    auto record{allocateRecord<T>()};
+    try {
+      new (record->Event) T(std::forward<Args>(args)...);
+    } catch (...) {
+      record->Segment->release();
+      throw;
+    }
+    record->Operations = operations;
+    publish(record);
+  }
+
+  template <typename T>
+  const Coalescing *coalescingFor() const {
+    auto id{impl::eventTypeID<T>()};
+    if (id < m_Coalescing.size() && m_Coalescing[id].Coalescer)
+      return &m_Coalescing[id];
+    return nullptr;
+  }
+
+  template <typename T>
+  void setCoalescing(Coalescing coalescing) {
+    auto id{impl::eventTypeID<T>()};
+    if (id >= m_Coalescing.size())
+      m_Coalescing.resize(id + 1);
+    m_Coalescing[id] = std::move(coalescing);
+  }
+
+  void publish(Record *record) {
+    record->Next = m_Head.load(std::memory_order_relaxed);
+    while (!m_Head.compare_exchange_weak(
+        record->Next,
+        record,
+        std::memory_order_release,
+        std::memory_order_relaxed
+    )) {
+    }
+  }
+
+  /** Takes every published record, returned oldest first. */
+  Record *takeAll() {
+    Record *head{m_Head.exchange(nullptr, std::memory_order_acquire)};
+
+    Record *reversed{nullptr};
+    while (head) {
+      auto next{head->Next};
+      head->Next = reversed;
+      reversed = head;
+      head = next;
+    }
+    return reversed;
+  }
+
+  /** Stable bucket sort on event type, types ordered by first appearance. */
+  static void groupByType(std::vector<Record *> &records) {
+    std::vector<std::pair<const EventOperations *, size_t>> offsets;
+    auto offsetFor{[&](const EventOperations *operations) -> size_t & {
+      for (auto &[type, offset] : offsets) {
+        if (type == operations)
+          return offset;
+      }
+      return offsets.emplace_back(operations, 0).second;
+    }};
 
-  std::optional<QueuedEvent> popEvent() {
-    std::lock_guard lockGuard{m_Lock};
+    for (auto record : records)
+      ++offsetFor(record->Operations);
 
-    if (m_Events.empty())
-      return std::nullopt;
+    size_t offset{0};
+    for (auto &[type, count] : offsets)
+      offset += std::exchange(count, offset);
 
-    auto event{std::move(m_Events.front())};
-    m_Events.pop();
-    return std::move(event);
+    std::vector<Record *> grouped(records.size());
+    for (auto record : records)
+      grouped[offsetFor(record->Operations)++] = record;
+    records.swap(grouped);
+  }
+
+  static void discard(Record *records) {
+    while (records) {
+      auto next{records->Next};
+      records->destroy();
+      records = next;
+    }
   }
 
 public:
+  Queue() = default;
+  Queue(const Queue &) = delete;
+  Queue &operator=(const Queue &) = delete;
+
+  ~Queue() {
+    discard(m_Pending);
+    discard(takeAll());
+  }
+
   template <typename T, typename... Args>
   void enqueue(Args &&...args) {
-    std::lock_guard lockGuard{m_Lock};
+    if (auto coalescing{coalescingFor<T>()}) {
+      T event(std::forward<Args>(args)...);
+      coalescing->Enqueue(*this, *coalescing->Coalescer, &event);
+      return;
+    }
+
+    emplace<T>(&OperationsFor<T>, std::forward<Args>(args)...);
+  }
+
+  /** Keeps only the most recently enqueued pending event of T. */
+  template <typename T>
+  void coalesceLatest() {
+    coalesceWith<T>([](T &pending, T &&incoming) {
+      pending = std::move(incoming);
+    });
+  }
+
+  /**
+   * Folds each event of T into the pending one with
+   * `reducer(pending, incoming)`.
+   */
+  template <typename T>
+  void coalesceWith(std::function<void(T &, T &&)> reducer) {
+    setCoalescing<T>({
+        .Coalescer = std::make_unique<MergingCoalescer<T>>(std::move(reducer)),
+        .Enqueue = &Queue::enqueueMerged<T>,
+    });
+  }
+
+  /** Drops events of T while an event with the same `key(event)` is pending. */
+  template <typename T, typename F>
+  void dedupeBy(F key) {
+    using K = std::remove_cvref_t<std::invoke_result_t<F &, const T &>>;
+    setCoalescing<T>({
+        .Coalescer = std::make_unique<KeyedCoalescer<T, K>>(std::move(key)),
+        .Enqueue = &Queue::enqueueKeyed<T, K>,
+    });
+  }
 
-    m_Events.push(QueuedEvent::template newFor<T>(
-        std::make_any<T>(std::forward<Args>(args)...)
-    ));
+  void dispatchOn(B &bus, C &context) {
+    while (m_Pending || (m_Pending = takeAll())) {
+      auto record{m_Pending};
+      m_Pending = record->Next;
+
+      struct Guard {
+        Record *Target;
+        ~Guard() { Target->destroy(); }
+      } guard{record};
+
+      record->Operations->Dispatch(bus, context, record->Event);
+    }
   }
 
-  void dispatchOn(Bus<C> &bus, C &context) {
-    while (auto event{popEvent()}) {
-      event->dispatch(bus, context);
+  /**
+   * Drains the queue once and dispatches the events in groups of the same
+   * type, resolving each type's dispatcher once per group. Dispatchers with
+   * batch handlers receive each group as a single batch. Events enqueued
+   * while dispatching are left for the next call.
+   */
+  void dispatchBatchedOn(
+      B &bus,
+      C &context,
+      BatchOrder order = BatchOrder::GroupByType
+  ) {
+    std::vector<Record *> records;
+    for (auto record{m_Pending}; record; record = record->Next)
+      records.push_back(record);
+    m_Pending = nullptr;
+    for (auto record{takeAll()}; record; record = record->Next)
+      records.push_back(record);
+
+    // if a handler throws, the groups not dispatched yet stay pending
+    struct Guard {
+      std::vector<Record *> &Targets;
+      Record *&Pending;
+      size_t Dispatched{0};
+
+      ~Guard() {
+        for (size_t i{0}; i < Dispatched; ++i)
+          Targets[i]->destroy();
+        for (auto i{Targets.size()}; i-- > Dispatched;) {
+          Targets[i]->Next = Pending;
+          Pending = Targets[i];
+        }
+      }
+    } guard{.Targets = records, .Pending = m_Pending};
+
+    if (order == BatchOrder::GroupByType)
+      groupByType(records);
+
+    for (size_t begin{0}; begin < records.size();) {
+      auto operations{records[begin]->Operations};
+      auto end{begin + 1};
+      while (end < records.size() && records[end]->Operations == operations)
+        ++end;
+
+      guard.Dispatched = end;
+      operations->DispatchBatch(
+          bus, context, records.data() + begin, end - begin
+      );
+      begin = end;
     }
   }
 };
-} // namespace solaris::core
\ No newline at end of file
+} // namespace solaris::core
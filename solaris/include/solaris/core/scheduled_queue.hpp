@@ -0,0 +1,193 @@
+#pragma once
+
+#include "bus.hpp"
+#include "timing_wheel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace solaris::core {
+/** Maps `std::chrono::steady_clock` onto scheduler ticks of a fixed length. */
+class TickClock {
+  std::chrono::steady_clock::time_point m_Epoch{
+      std::chrono::steady_clock::now()
+  };
+  std::chrono::nanoseconds m_TickLength;
+
+public:
+  using Tick = uint64_t;
+
+  explicit TickClock(
+      std::chrono::nanoseconds tickLength = std::chrono::milliseconds{1}
+  )
+      : m_TickLength{tickLength} {}
+
+  /** Ticks elapsed since the clock was created. */
+  [[nodiscard]] Tick now() const {
+    auto elapsed{std::chrono::steady_clock::now() - m_Epoch};
+    return Tick(elapsed / m_TickLength);
+  }
+
+  /** Number of ticks covering `duration`, rounded up. */
+  [[nodiscard]] Tick ticks(std::chrono::nanoseconds duration) const {
+    return Tick((duration + m_TickLength - std::chrono::nanoseconds{1}) /
+                m_TickLength);
+  }
+};
+
+/**
+ * Event queue where each event has a due tick and a priority.
+ *
+ * Pending events live in a hierarchical timing wheel, so scheduling and
+ * firing are O(1) regardless of how many timers are pending. Time only moves
+ * when `advance`/`advanceTo` is called, e.g. once per frame with
+ * `TickClock::now()`. `dispatchOn` dispatches the events that are due, by due
+ * tick, then highest priority first, then in the order they were scheduled.
+ *
+ * Not thread-safe: schedule from the thread that dispatches, and route
+ * events from other threads through `Queue`. B is the bus flavor, as for
+ * `Queue`.
+ */
+template <typename C, typename B = Bus<C>>
+  requires std::derived_from<B, HandlerRegistry<C>>
+class ScheduledQueue {
+public:
+  using Tick = uint64_t;
+
+  struct Schedule {
+    /** Ticks from now until the event is due. */
+    Tick Delay{0};
+    /** Among events due on the same tick, higher priorities go first. */
+    int Priority{0};
+  };
+
+private:
+  struct EventOperations {
+    void (*Dispatch)(B &, C &, void *);
+    void (*Delete)(void *);
+  };
+
+  struct Entry {
+    const EventOperations *Operations;
+    void *Event;
+    int Priority;
+    uint64_t Sequence;
+  };
+
+  struct DueEntry {
+    Tick Due;
+    Entry Event;
+  };
+
+  template <typename T>
+  static void dispatcher(B &bus, C &context, void *event) {
+    bus.dispatch(*static_cast<const T *>(event), context);
+  }
+
+  template <typename T>
+  static void deleter(void *event) {
+    delete static_cast<T *>(event);
+  }
+
+  template <typename T>
+  static constexpr EventOperations OperationsFor{
+      .Dispatch = &ScheduledQueue::dispatcher<T>,
+      .Delete = &ScheduledQueue::deleter<T>,
+  };
+
+  TimingWheel<Entry> m_Wheel;
+  std::vector<DueEntry> m_Due{};
+  uint64_t m_NextSequence{0};
+
+public:
+  explicit ScheduledQueue(Tick now = 0) : m_Wheel{now} {}
+  ScheduledQueue(const ScheduledQueue &) = delete;
+  ScheduledQueue &operator=(const ScheduledQueue &) = delete;
+
+  ~ScheduledQueue() {
+    for (auto &due : m_Due)
+      due.Event.Operations->Delete(due.Event.Event);
+    m_Wheel.clear([](Tick, Entry entry) {
+      entry.Operations->Delete(entry.Event);
+    });
+  }
+
+  [[nodiscard]] Tick now() const { return m_Wheel.now(); }
+
+  /** Number of events that have not been dispatched yet. */
+  [[nodiscard]] size_t size() const { return m_Wheel.size() + m_Due.size(); }
+
+  template <typename T, typename... Args>
+  void scheduleAt(Tick due, int priority, Args &&...args) {
+    auto event{std::make_unique<T>(std::forward<Args>(args)...)};
+    m_Wheel.insert(
+        due,
+        {
+            .Operations = &OperationsFor<T>,
+            .Event = event.get(),
+            .Priority = priority,
+            .Sequence = m_NextSequence++,
+        }
+    );
+    // the wheel owns the event from here on
+    event.release();
+  }
+
+  template <typename T, typename... Args>
+  void schedule(Schedule schedule, Args &&...args) {
+    scheduleAt<T>(
+        now() + schedule.Delay,
+        schedule.Priority,
+        std::forward<Args>(args)...
+    );
+  }
+
+  /** Schedules the event for the current tick at the default priority. */
+  template <typename T, typename... Args>
+  void enqueue(Args &&...args) {
+    schedule<T>(Schedule{}, std::forward<Args>(args)...);
+  }
+
+  void advance(Tick ticks = 1) { advanceTo(now() + ticks); }
+
+  /** Moves time forward; never moves it back. */
+  void advanceTo(Tick tick) {
+    m_Wheel.advanceTo(tick, [this](Tick due, Entry entry) {
+      m_Due.push_back({.Due = due, .Event = entry});
+    });
+  }
+
+  /**
+   * Dispatches every event due by the current tick. Events scheduled while
+   * dispatching wait for the next call, even when they are due immediately.
+   */
+  void dispatchOn(B &bus, C &context) {
+    // picks up events scheduled for the current tick
+    advanceTo(now());
+
+    auto due{std::exchange(m_Due, {})};
+    std::ranges::sort(due, [](const DueEntry &a, const DueEntry &b) {
+      if (a.Due != b.Due)
+        return a.Due < b.Due;
+      if (a.Event.Priority != b.Event.Priority)
+        return a.Event.Priority > b.Event.Priority;
+      return a.Event.Sequence < b.Event.Sequence;
+    });
+
+    struct Guard {
+      std::vector<DueEntry> &Entries;
+      ~Guard() {
+        for (auto &entry : Entries)
+          entry.Event.Operations->Delete(entry.Event.Event);
+      }
+    } guard{due};
+
+    for (auto &entry : due)
+      entry.Event.Operations->Dispatch(bus, context, entry.Event.Event);
+  }
+};
+} // namespace solaris::core
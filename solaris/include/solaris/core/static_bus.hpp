@@ -0,0 +1,75 @@
+#pragma once
+
+#include "bus.hpp"
+#include "dispatcher.hpp"
+#include <concepts>
+#include <span>
+#include <tuple>
+#include <typeindex>
+
+namespace solaris::core {
+/**
+ * Event bus over a fixed set of event types. Every event type owns a slot in
+ * a tuple, so dispatching is a direct call into that slot's dispatcher with
+ * no hashing or RTTI. Registering a handler for an event type outside of
+ * `Events` throws std::invalid_argument.
+ */
+template <typename C, typename... Events>
+class StaticBus : public HandlerRegistry<C> {
+  std::tuple<Dispatcher<Events, C>...> m_Dispatchers{};
+
+protected:
+  BaseDispatcher<C> *registryDispatcher(
+      std::type_index event,
+      typename HandlerRegistry<C>::DispatcherFactory
+  ) override {
+    BaseDispatcher<C> *found{nullptr};
+    ((event == typeid(Events) &&
+      (found = &std::get<Dispatcher<Events, C>>(m_Dispatchers))) ||
+     ...);
+    return found;
+  }
+
+public:
+  template <typename E>
+  static constexpr bool Carries{(std::same_as<E, Events> || ...)};
+
+  /** Observer handlers of every event type fan out on `pool`. */
+  void setObserverPool(ThreadPool *pool) {
+    std::apply(
+        [pool](auto &...dispatchers) {
+          (dispatchers.setObserverPool(pool), ...);
+        },
+        m_Dispatchers
+    );
+  }
+
+  template <typename E>
+    requires(Carries<E>)
+  Dispatcher<E, C> &getDispatcherFor() {
+    return std::get<Dispatcher<E, C>>(m_Dispatchers);
+  }
+
+  /** Returns the dispatcher for E, or nullptr if the bus doesn't carry E. */
+  template <typename E>
+  Dispatcher<E, C> *findDispatcher() {
+    if constexpr (Carries<E>) {
+      return &std::get<Dispatcher<E, C>>(m_Dispatchers);
+    } else {
+      return nullptr;
+    }
+  }
+
+  template <typename E>
+  void dispatch(const E &event, C &context) {
+    static_assert(Carries<E>, "event type is not carried by this bus");
+    std::get<Dispatcher<E, C>>(m_Dispatchers).dispatch(event, context);
+  }
+
+  template <typename E>
+  void dispatchBatch(std::span<const E> events, C &context) {
+    static_assert(Carries<E>, "event type is not carried by this bus");
+    std::get<Dispatcher<E, C>>(m_Dispatchers).dispatchBatch(events, context);
+  }
+};
+} // namespace solaris::core
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace solaris::core {
+/**
+ * Fixed set of worker threads running submitted tasks in FIFO order.
+ *
+ * `parallelFor` lets the calling thread take part in the work and only waits
+ * for the work itself, not for helper tasks to be picked up, so it may be
+ * nested inside tasks of the same pool without deadlocking.
+ */
+class ThreadPool {
+  std::mutex m_Mutex{};
+  std::condition_variable m_Wake{};
+  std::deque<std::function<void()>> m_Tasks{};
+  bool m_Stopping{false};
+  std::vector<std::jthread> m_Workers{};
+
+  void work() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock lock{m_Mutex};
+        m_Wake.wait(lock, [this] { return m_Stopping || !m_Tasks.empty(); });
+        if (m_Tasks.empty())
+          return;
+        task = std::move(m_Tasks.front());
+        m_Tasks.pop_front();
+      }
+      task();
+    }
+  }
+
+public:
+  explicit ThreadPool(
+      size_t threads = std::max(1u, std::thread::hardware_concurrency())
+  ) {
+    m_Workers.reserve(threads);
+    for (size_t i{0}; i < threads; ++i)
+      m_Workers.emplace_back([this] { work(); });
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /** Finishes the queued tasks, then joins the workers. */
+  ~ThreadPool() {
+    {
+      std::scoped_lock lock{m_Mutex};
+      m_Stopping = true;
+    }
+    m_Wake.notify_all();
+  }
+
+  [[nodiscard]] size_t size() const { return m_Workers.size(); }
+
+  void submit(std::function<void()> task) {
+    {
+      std::scoped_lock lock{m_Mutex};
+      m_Tasks.push_back(std::move(task));
+    }
+    m_Wake.notify_one();
+  }
+
+  /**
+   * Calls `function(i)` for every i in [0, count) on the workers and the
+   * calling thread, and returns once all calls are done. The first exception
+   * thrown by a call is rethrown here after the others have finished.
+   */
+  template <typename F>
+  void parallelFor(size_t count, F &&function) {
+    if (count == 0)
+      return;
+
+    struct Job {
+      size_t Count;
+      std::atomic<size_t> Next{0};
+      std::mutex Mutex{};
+      std::condition_variable Finished{};
+      size_t Done{0};
+      std::exception_ptr Error{};
+
+      explicit Job(size_t count) : Count{count} {}
+    };
+
+    auto job{std::make_shared<Job>(count)};
+    // late helpers only touch the shared job, never `function`
+    auto run{[job, &function] {
+      size_t finished{0};
+      std::exception_ptr error{};
+      for (auto index{job->Next++}; index < job->Count; index = job->Next++) {
+        try {
+          function(index);
+        } catch (...) {
+          if (!error)
+            error = std::current_exception();
+        }
+        ++finished;
+      }
+      if (finished == 0)
+        return;
+
+      std::scoped_lock lock{job->Mutex};
+      if (error && !job->Error)
+        job->Error = error;
+      job->Done += finished;
+      if (job->Done == job->Count)
+        job->Finished.notify_all();
+    }};
+
+    auto helpers{std::min(count - 1, size())};
+    for (size_t i{0}; i < helpers; ++i)
+      submit(run);
+    run();
+
+    std::unique_lock lock{job->Mutex};
+    job->Finished.wait(lock, [&job] { return job->Done == job->Count; });
+    if (job->Error)
+      std::rethrow_exception(job->Error);
+  }
+};
+} // namespace solaris::core
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace solaris::core {
+/**
+ * Hierarchical timing wheel keyed by integer ticks.
+ *
+ * Each level has 64 slots; level L covers 64^(L+1) ticks. A value is stored
+ * at the coarsest level on which its due tick differs from the current tick,
+ * and moves down a level whenever the wheel reaches the start of its slot.
+ * Inserting is O(1) and every value is touched at most once per level before
+ * it expires. Empty stretches of time are skipped using per-level occupancy
+ * masks, so advancing far ahead costs nothing when no value is due.
+ */
+template <typename T>
+class TimingWheel {
+public:
+  using Tick = uint64_t;
+
+private:
+  static constexpr size_t SlotBits{6};
+  static constexpr size_t SlotCount{size_t{1} << SlotBits};
+  static constexpr Tick SlotMask{SlotCount - 1};
+  static constexpr size_t Levels{
+      (std::numeric_limits<Tick>::digits + SlotBits - 1) / SlotBits
+  };
+  static constexpr uint32_t Nil{std::numeric_limits<uint32_t>::max()};
+
+  struct Node {
+    Tick Due;
+    uint32_t Next;
+    T Value;
+  };
+
+  struct List {
+    uint32_t Head{Nil};
+    uint32_t Tail{Nil};
+  };
+
+  struct Level {
+    std::array<List, SlotCount> Slots{};
+    uint64_t Occupied{0};
+  };
+
+  Tick m_Now;
+  std::vector<Node> m_Nodes{};
+  uint32_t m_FreeNodes{Nil};
+  size_t m_Size{0};
+  std::array<Level, Levels> m_Levels{};
+  // values that were already due when inserted or cascaded
+  List m_Expired{};
+
+  static Tick digit(Tick tick, size_t level) {
+    return (tick >> (level * SlotBits)) & SlotMask;
+  }
+
+  /** Mask of the tick bits above `level`. */
+  static Tick upperMask(size_t level) {
+    auto shift{(level + 1) * SlotBits};
+    if (shift >= std::numeric_limits<Tick>::digits)
+      return 0;
+    return ~((Tick{1} << shift) - 1);
+  }
+
+  void append(List &list, uint32_t index) {
+    m_Nodes[index].Next = Nil;
+    if (list.Tail == Nil)
+      list.Head = index;
+    else
+      m_Nodes[list.Tail].Next = index;
+    list.Tail = index;
+  }
+
+  void place(uint32_t index) {
+    auto due{m_Nodes[index].Due};
+    if (due <= m_Now) {
+      append(m_Expired, index);
+      return;
+    }
+
+    auto level{(std::bit_width(due ^ m_Now) - 1) / SlotBits};
+    auto slot{digit(due, level)};
+    append(m_Levels[level].Slots[slot], index);
+    m_Levels[level].Occupied |= uint64_t{1} << slot;
+  }
+
+  List take(size_t level, Tick slot) {
+    auto &wheel{m_Levels[level]};
+    wheel.Occupied &= ~(uint64_t{1} << slot);
+    return std::exchange(wheel.Slots[slot], List{});
+  }
+
+  /** Hands every value in the list to `expired` and recycles its node. */
+  template <typename F>
+  void expire(List list, F &expired) {
+    for (auto index{list.Head}; index != Nil;) {
+      auto &node{m_Nodes[index]};
+      auto next{node.Next};
+      auto due{node.Due};
+      T value{std::move(node.Value)};
+
+      node.Next = m_FreeNodes;
+      m_FreeNodes = index;
+      --m_Size;
+
+      expired(due, std::move(value));
+      index = next;
+    }
+  }
+
+  /** The earliest tick at which some slot needs to be cascaded or fired. */
+  [[nodiscard]] Tick nextEventTick() const {
+    if (m_Expired.Head != Nil)
+      return m_Now;
+
+    auto next{std::numeric_limits<Tick>::max()};
+    for (size_t level{0}; level < Levels; ++level) {
+      auto current{digit(m_Now, level)};
+      auto later{m_Levels[level].Occupied & ~((uint64_t{2} << current) - 1)};
+      if (later == 0)
+        continue;
+
+      auto slot{Tick(std::countr_zero(later))};
+      auto tick{(m_Now & upperMask(level)) | (slot << (level * SlotBits))};
+      next = std::min(next, tick);
+    }
+    return next;
+  }
+
+public:
+  explicit TimingWheel(Tick now = 0) : m_Now{now} {}
+
+  [[nodiscard]] Tick now() const { return m_Now; }
+
+  [[nodiscard]] size_t size() const { return m_Size; }
+
+  [[nodiscard]] bool empty() const { return m_Size == 0; }
+
+  /** Values due at or before the current tick expire on the next advance. */
+  void insert(Tick due, T value) {
+    uint32_t index;
+    if (m_FreeNodes != Nil) {
+      index = m_FreeNodes;
+      m_FreeNodes = m_Nodes[index].Next;
+      m_Nodes[index].Due = due;
+      m_Nodes[index].Value = std::move(value);
+    } else {
+      index = uint32_t(m_Nodes.size());
+      m_Nodes.push_back({.Due = due, .Next = Nil, .Value = std::move(value)});
+    }
+
+    ++m_Size;
+    place(index);
+  }
+
+  /**
+   * Moves the wheel forward to `tick`, calling `expired(due, value)` for
+   * every value that is due by then, in order of due tick.
+   */
+  template <typename F>
+  void advanceTo(Tick tick, F &&expired) {
+    // with nothing pending there is no next event, not even at the last tick
+    while (m_Size != 0) {
+      auto next{nextEventTick()};
+      if (next > tick)
+        break;
+      m_Now = next;
+
+      // bring coarse slots starting at this tick down to finer levels
+      for (size_t level{Levels - 1}; level > 0; --level) {
+        auto belowMask{(Tick{1} << (level * SlotBits)) - 1};
+        auto slot{digit(m_Now, level)};
+        if ((m_Now & belowMask) != 0 ||
+            !(m_Levels[level].Occupied & (uint64_t{1} << slot)))
+          continue;
+
+        auto list{take(level, slot)};
+        for (auto index{list.Head}; index != Nil;) {
+          auto following{m_Nodes[index].Next};
+          place(index);
+          index = following;
+        }
+      }
+
+      expire(std::exchange(m_Expired, List{}), expired);
+
+      auto slot{digit(m_Now, 0)};
+      if (m_Levels[0].Occupied & (uint64_t{1} << slot))
+        expire(take(0, slot), expired);
+    }
+
+    m_Now = std::max(m_Now, tick);
+  }
+
+  /** Removes every pending value, calling `removed(due, value)` for each. */
+  template <typename F>
+  void clear(F &&removed) {
+    expire(std::exchange(m_Expired, List{}), removed);
+    for (size_t level{0}; level < Levels; ++level) {
+      for (Tick slot{0}; slot < SlotCount; ++slot) {
+        if (m_Levels[level].Occupied & (uint64_t{1} << slot))
+          expire(take(level, slot), removed);
+      }
+    }
+  }
+};
+} // namespace solaris::core
@@ -1,25 +1,487 @@
 #pragma once
 
 #include <algorithm>
+#include <chrono>
+#include <concepts>
 #include <cstddef>
-#include <iostream>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <optional>
 #include <ranges>
 #include <set>
+#include <solaris/core/bus.hpp>
+#include <solaris/framework/prefab.hpp>
 #include <solaris/framework/runtime_vector.hpp>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <typeindex>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 namespace solaris {
 using Entity = size_t;
 
+/** Entities are numbered from 1, so no entity is ever `NoEntity`. */
+inline constexpr Entity NoEntity{0};
+
+/** Query term matching archetypes that do not have component T. */
+template <typename T>
+struct Without {};
+
+/** Query term yielding a T pointer that is null where T is missing. */
+template <typename T>
+struct Optional {};
+
+/**
+ * Query term matching archetypes that have at least one of Ts, yielding a
+ * pointer per type like `Optional`.
+ */
+template <typename... Ts>
+struct AnyOf {};
+
+/**
+ * Query term matching archetypes that share a value of T, which every row
+ * reads through `getShared`; see `World::setShared`.
+ */
+template <typename T>
+struct Shared {};
+
+namespace impl {
+template <typename... Ts>
+struct TypeList {};
+
+template <typename... Lists>
+struct Concat;
+
+template <>
+struct Concat<> {
+  using Type = TypeList<>;
+};
+
+template <typename... Ts, typename... Lists>
+struct Concat<TypeList<Ts...>, Lists...> {
+  template <typename List>
+  struct Prepend;
+
+  template <typename... Us>
+  struct Prepend<TypeList<Us...>> {
+    using Type = TypeList<Ts..., Us...>;
+  };
+
+  using Type = typename Prepend<typename Concat<Lists...>::Type>::Type;
+};
+
+/** Component types checked when matching an archetype against a query. */
+struct QueryFilter {
+  std::vector<std::type_index> Required;
+  std::vector<std::type_index> Excluded;
+  std::vector<std::vector<std::type_index>> AnyOf;
+  std::vector<std::type_index> Shared;
+};
+
+/**
+ * How a query term filters archetypes, and which components it yields:
+ * `Required` through `getField`, `Optional` as nullable pointers and
+ * `Shared` through `getShared`.
+ */
+template <typename T>
+struct QueryTerm {
+  using Required = TypeList<T>;
+  using Optional = TypeList<>;
+  using Shared = TypeList<>;
+
+  static void describe(QueryFilter &filter) {
+    filter.Required.emplace_back(typeid(T));
+  }
+};
+
+template <typename T>
+struct QueryTerm<Without<T>> {
+  using Required = TypeList<>;
+  using Optional = TypeList<>;
+  using Shared = TypeList<>;
+
+  static void describe(QueryFilter &filter) {
+    filter.Excluded.emplace_back(typeid(T));
+  }
+};
+
+template <typename T>
+struct QueryTerm<solaris::Optional<T>> {
+  using Required = TypeList<>;
+  using Optional = TypeList<T>;
+  using Shared = TypeList<>;
+
+  static void describe(QueryFilter &) {}
+};
+
+template <typename... Ts>
+struct QueryTerm<solaris::AnyOf<Ts...>> {
+  using Required = TypeList<>;
+  using Optional = TypeList<Ts...>;
+  using Shared = TypeList<>;
+
+  static void describe(QueryFilter &filter) {
+    filter.AnyOf.push_back({typeid(Ts)...});
+  }
+};
+
+template <typename T>
+struct QueryTerm<solaris::Shared<T>> {
+  using Required = TypeList<>;
+  using Optional = TypeList<>;
+  using Shared = TypeList<T>;
+
+  static void describe(QueryFilter &filter) {
+    filter.Shared.emplace_back(typeid(T));
+  }
+};
+
+template <typename Required, typename Optional, typename Shared>
+class QueryRow;
+
+/**
+ * Components of a query result: the required ones through `getField`, the
+ * optional ones through `tryGetField`, which is null where missing, and the
+ * shared ones through `getShared`.
+ */
+template <typename... Cs, typename... Os, typename... Ss>
+class QueryRow<TypeList<Cs...>, TypeList<Os...>, TypeList<Ss...>>
+    : public SelectiveObjectRef<Cs...> {
+  std::tuple<Os *...> m_Optionals;
+  std::tuple<const Ss *...> m_Shared;
+
+public:
+  QueryRow(
+      const SelectiveObjectRef<Cs...> &ref,
+      std::tuple<Os *...> optionals,
+      std::tuple<const Ss *...> shared
+  )
+      : SelectiveObjectRef<Cs...>{ref}, m_Optionals{optionals},
+        m_Shared{shared} {}
+
+  template <typename T>
+  [[nodiscard]] T *tryGetField() const {
+    return std::get<T *>(m_Optionals);
+  }
+
+  template <typename T>
+  [[nodiscard]] const T &getShared() const {
+    return *std::get<const T *>(m_Shared);
+  }
+};
+
+template <typename... Terms>
+using QueryRowFor = QueryRow<
+    typename Concat<typename QueryTerm<Terms>::Required...>::Type,
+    typename Concat<typename QueryTerm<Terms>::Optional...>::Type,
+    typename Concat<typename QueryTerm<Terms>::Shared...>::Type>;
+
+/**
+ * Value of a shared component. Archetypes hold it once for all their rows,
+ * and archetypes with equal values hold the same copy.
+ */
+struct SharedComponent {
+  std::type_index Type;
+  std::shared_ptr<const void> Value;
+  bool (*Equals)(const void *, const void *);
+
+  template <typename T>
+  static SharedComponent of(T value) {
+    return {
+        .Type = typeid(T),
+        .Value = std::make_shared<const T>(std::move(value)),
+        .Equals =
+            [](const void *a, const void *b) {
+              return *static_cast<const T *>(a) == *static_cast<const T *>(b);
+            },
+    };
+  }
+
+  bool operator==(const SharedComponent &other) const {
+    return Type == other.Type &&
+           (Value == other.Value || Equals(Value.get(), other.Value.get()));
+  }
+};
+
+inline bool hasComponent(const RuntimeStruct &shape, std::type_index type) {
+  return std::ranges::contains(
+      shape.Members,
+      type,
+      [](const RuntimeStruct::Member &member) {
+        return member.Field.TypeIndex;
+      }
+  );
+}
+
+/** Offset of T in `shape`, if it has a T. */
+template <typename T>
+std::optional<size_t> componentOffset(const RuntimeStruct &shape) {
+  auto member{std::ranges::find(
+      shape.Members,
+      std::type_index{typeid(T)},
+      [](const RuntimeStruct::Member &member) {
+        return member.Field.TypeIndex;
+      }
+  )};
+  if (member == shape.Members.end())
+    return std::nullopt;
+  return member->Offset;
+}
+
+/**
+ * Pairs (source, target) of one relation, indexed both ways so that the
+ * sources of a target are found without scanning the world.
+ */
+class RelationIndex {
+  std::unordered_map<Entity, std::vector<Entity>> m_Sources;
+  std::unordered_map<Entity, std::vector<Entity>> m_Targets;
+
+  static std::span<const Entity> find(
+      const std::unordered_map<Entity, std::vector<Entity>> &edges,
+      Entity entity
+  ) {
+    auto it{edges.find(entity)};
+    if (it == edges.end())
+      return {};
+    return it->second;
+  }
+
+  static void unlink(
+      std::unordered_map<Entity, std::vector<Entity>> &edges,
+      Entity from,
+      Entity to
+  ) {
+    auto it{edges.find(from)};
+    if (it == edges.end())
+      return;
+    std::erase(it->second, to);
+    if (it->second.empty())
+      edges.erase(it);
+  }
+
+public:
+  /** Returns false if the pair already existed. */
+  bool add(Entity source, Entity target) {
+    auto &targets{m_Targets[source]};
+    if (std::ranges::contains(targets, target))
+      return false;
+    targets.push_back(target);
+    m_Sources[target].push_back(source);
+    return true;
+  }
+
+  /** Returns false if there was no such pair. */
+  bool remove(Entity source, Entity target) {
+    if (!contains(source, target))
+      return false;
+    unlink(m_Targets, source, target);
+    unlink(m_Sources, target, source);
+    return true;
+  }
+
+  [[nodiscard]] bool contains(Entity source, Entity target) const {
+    return std::ranges::contains(targets(source), target);
+  }
+
+  [[nodiscard]] std::span<const Entity> sources(Entity target) const {
+    return find(m_Sources, target);
+  }
+
+  [[nodiscard]] std::span<const Entity> targets(Entity source) const {
+    return find(m_Targets, source);
+  }
+
+  /** Removes every pair `entity` is part of, on either side. */
+  void forget(Entity entity) {
+    if (auto it{m_Targets.find(entity)}; it != m_Targets.end()) {
+      for (auto target : it->second)
+        unlink(m_Sources, target, entity);
+      m_Targets.erase(it);
+    }
+    if (auto it{m_Sources.find(entity)}; it != m_Sources.end()) {
+      for (auto source : it->second)
+        unlink(m_Targets, source, entity);
+      m_Sources.erase(it);
+    }
+  }
+};
+
+enum class ComponentEvent { Added, Set, Removed };
+
+/** Buffers the lifecycle events of one component type until a flush. */
+class EventRecorder {
+public:
+  virtual ~EventRecorder() = default;
+
+  virtual void record(ComponentEvent event, Entity entity) = 0;
+
+  /** Dispatches the buffered events if `context` is of the bus's type. */
+  virtual void flush(const std::type_info &type, void *context) = 0;
+};
+
+/** Keeps an index of component values up to date as entities change. */
+class ComponentIndex {
+public:
+  virtual ~ComponentIndex() = default;
+
+  virtual void update(Entity entity, const void *component) = 0;
+
+  virtual void erase(Entity entity) = 0;
+};
+} // namespace impl
+
+/** `entity` was given a T, or was created or instantiated with one. */
+template <typename T>
+struct ComponentAdded {
+  Entity EntityID;
+};
+
+/** The T of `entity` was replaced through `World::add` or `World::modify`. */
+template <typename T>
+struct ComponentSet {
+  Entity EntityID;
+};
+
+/** The T of `entity` was removed, or the entity destroyed. */
+template <typename T>
+struct ComponentRemoved {
+  Entity EntityID;
+};
+
+/**
+ * Dispatches the ComponentAdded, ComponentSet and ComponentRemoved events of
+ * T on a bus of flavor B, in one batch per event type; see `World::observe`.
+ */
+template <typename T, typename C, typename B = core::Bus<C>>
+class ComponentObserver final : public impl::EventRecorder {
+  B &m_Bus;
+  std::vector<ComponentAdded<T>> m_Added{};
+  std::vector<ComponentSet<T>> m_Set{};
+  std::vector<ComponentRemoved<T>> m_Removed{};
+
+  template <typename E>
+  void dispatch(const std::vector<E> &events, C &context) {
+    if (!events.empty())
+      m_Bus.dispatchBatch(std::span<const E>{events}, context);
+  }
+
+public:
+  explicit ComponentObserver(B &bus) : m_Bus{bus} {}
+
+  void record(impl::ComponentEvent event, Entity entity) override {
+    switch (event) {
+    case impl::ComponentEvent::Added:
+      m_Added.push_back({entity});
+      break;
+    case impl::ComponentEvent::Set:
+      m_Set.push_back({entity});
+      break;
+    case impl::ComponentEvent::Removed:
+      m_Removed.push_back({entity});
+      break;
+    }
+  }
+
+  void flush(const std::type_info &type, void *context) override {
+    if (type != typeid(C))
+      return;
+    auto &typed{*static_cast<C *>(context)};
+    // events raised by the handlers wait for the next flush
+    auto added{std::exchange(m_Added, {})};
+    auto set{std::exchange(m_Set, {})};
+    auto removed{std::exchange(m_Removed, {})};
+    dispatch(added, typed);
+    dispatch(set, typed);
+    dispatch(removed, typed);
+  }
+};
+
+/**
+ * Hash index from a key of each T to the entities with that key, created by
+ * `World::addIndex`. Lookups are O(1) instead of a scan over every T.
+ */
+template <typename T, typename K>
+class ValueIndex final : public impl::ComponentIndex {
+  struct Slot {
+    K Key;
+    size_t Position;
+  };
+
+  std::function<K(const T &)> m_KeyOf;
+  std::unordered_map<K, std::vector<Entity>> m_Entities{};
+  std::unordered_map<Entity, Slot> m_Slots{};
+
+public:
+  explicit ValueIndex(std::function<K(const T &)> keyOf)
+      : m_KeyOf{std::move(keyOf)} {}
+
+  /** The entities whose T has `key`, in no particular order. */
+  [[nodiscard]] std::span<const Entity> find(const K &key) const {
+    auto it{m_Entities.find(key)};
+    if (it == m_Entities.end())
+      return {};
+    return it->second;
+  }
+
+  /** An entity whose T has `key`, for keys that are unique. */
+  [[nodiscard]] std::optional<Entity> findOne(const K &key) const {
+    auto entities{find(key)};
+    if (entities.empty())
+      return std::nullopt;
+    return entities.front();
+  }
+
+  [[nodiscard]] size_t count(const K &key) const { return find(key).size(); }
+
+  void update(Entity entity, const void *component) override {
+    auto key{m_KeyOf(*static_cast<const T *>(component))};
+    if (auto it{m_Slots.find(entity)}; it != m_Slots.end()) {
+      if (it->second.Key == key)
+        return;
+      erase(entity);
+    }
+
+    auto &entities{m_Entities[key]};
+    m_Slots.emplace(entity, Slot{std::move(key), entities.size()});
+    entities.push_back(entity);
+  }
+
+  void erase(Entity entity) override {
+    auto it{m_Slots.find(entity)};
+    if (it == m_Slots.end())
+      return;
+
+    // move the last entity with the key into the freed position
+    auto bucket{m_Entities.find(it->second.Key)};
+    auto &entities{bucket->second};
+    auto position{it->second.Position};
+    entities[position] = entities.back();
+    m_Slots.at(entities[position]).Position = position;
+    entities.pop_back();
+    if (entities.empty())
+      m_Entities.erase(bucket);
+    m_Slots.erase(it);
+  }
+};
+
 class Archetype {
   RuntimeVector m_Storage;
   std::vector<Entity> m_Entities;
+  std::vector<impl::SharedComponent> m_Shared;
 
 public:
-  Archetype(RuntimeStruct runtimeStruct)
-      : m_Storage{std::move(runtimeStruct)} {}
+  /** `shared` must be sorted by type. */
+  Archetype(
+      RuntimeStruct runtimeStruct,
+      std::vector<impl::SharedComponent> shared = {}
+  )
+      : m_Storage{std::move(runtimeStruct)}, m_Shared{std::move(shared)} {}
 
   Archetype() : m_Storage{RuntimeStruct()} {}
 
@@ -31,8 +493,27 @@ public:
 
   const std::vector<Entity> &entities() const { return m_Entities; }
 
+  const std::vector<impl::SharedComponent> &sharedComponents() const {
+    return m_Shared;
+  }
+
+  [[nodiscard]] bool hasShared(std::type_index type) const {
+    return std::ranges::contains(m_Shared, type, &impl::SharedComponent::Type);
+  }
+
+  /** The shared T of every row, or null if the archetype has none. */
+  template <typename T>
+  [[nodiscard]] const T *shared() const {
+    auto it{std::ranges::find(
+        m_Shared, std::type_index{typeid(T)}, &impl::SharedComponent::Type
+    )};
+    if (it == m_Shared.end())
+      return nullptr;
+    return static_cast<const T *>(it->Value.get());
+  }
+
   Archetype withComponent(RuntimeField field) const {
-    return {m_Storage.runtimeStruct().withField(field)};
+    return {m_Storage.runtimeStruct().withField(field), m_Shared};
   }
 
   Archetype withComponents(const std::ranges::range auto &fields) const {
@@ -40,7 +521,7 @@ public:
     for (const RuntimeField &field : fields) {
       newRuntimeStruct = newRuntimeStruct.withField(field);
     }
-    return newRuntimeStruct;
+    return {newRuntimeStruct, m_Shared};
   }
 
   [[nodiscard]] RawObjectPtr get(size_t index) const {
@@ -54,6 +535,51 @@ public:
 
     return {index, obj};
   }
+
+  /** Appends rows, left for the caller to construct, for `entities`. */
+  size_t add(std::ranges::sized_range auto &&entities) {
+    auto index{m_Entities.size()};
+    m_Storage.pushBack(std::ranges::size(entities));
+    for (auto entity : entities)
+      m_Entities.push_back(entity);
+    return index;
+  }
+
+  [[nodiscard]] size_t size() const { return m_Entities.size(); }
+
+  /** Start of the object in row `index`, to use with member offsets. */
+  [[nodiscard]] uint8_t *row(size_t index) const {
+    return m_Storage.data() + index * runtimeStruct().Stride;
+  }
+
+  /**
+   * Removes row `index`, whose fields were already moved out or destroyed.
+   * Returns the entity that was moved into the row, if any.
+   */
+  std::optional<Entity> eraseMoved(size_t index) {
+    m_Storage.eraseMoved(index);
+    m_Entities[index] = m_Entities.back();
+    m_Entities.pop_back();
+    if (index == m_Entities.size())
+      return std::nullopt;
+    return m_Entities[index];
+  }
+
+  void swap(size_t a, size_t b) {
+    m_Storage.swap(a, b);
+    std::swap(m_Entities[a], m_Entities[b]);
+  }
+
+  /** Whether storage holds more than twice the rows it needs. */
+  [[nodiscard]] bool overProvisioned() const {
+    return m_Storage.capacity() > 2 * m_Storage.size() ||
+           m_Entities.capacity() > 2 * m_Entities.size();
+  }
+
+  void shrinkToFit() {
+    m_Storage.shrinkToFit();
+    m_Entities.shrink_to_fit();
+  }
 };
 
 class World {
@@ -64,73 +590,127 @@ class World {
 
   Entity m_NextEntity{0};
   std::vector<Archetype> m_Archetypes;
+  size_t m_ArchetypeVersion{0};
+  size_t m_CompactionCursor{0};
+  /**
+   * Sort policies by component type, each restoring the order of an
+   * archetype and returning whether it applies to that archetype.
+   */
+  std::vector<
+      std::pair<std::type_index, std::function<bool(World &, size_t)>>>
+      m_SortPolicies;
   std::unordered_map<Entity, AliveEntity> m_Entities;
+  std::unordered_map<std::type_index, impl::RelationIndex> m_Relations;
+  std::unordered_map<std::type_index, std::shared_ptr<void>> m_Singletons;
+  std::unordered_map<
+      std::type_index,
+      std::vector<std::unique_ptr<impl::ComponentIndex>>>
+      m_Indexes;
+  std::unordered_map<
+      std::type_index,
+      std::vector<std::unique_ptr<impl::EventRecorder>>>
+      m_Observers;
 
 public:
-  template <typename... Cs>
+  template <typename... Ts>
+  struct QueryResult;
+
+  /**
+   * Query over the archetypes matching every term, where a term is either a
+   * required component type or one of `Without`, `Optional` and `AnyOf`.
+   * Terms are checked once per archetype, so entities of archetypes that do
+   * not match are never visited.
+   */
+  template <typename... Terms>
   class SelectiveView {
-    std::set<std::type_index> m_Types;
+    impl::QueryFilter m_Filter;
+
+    template <typename... Cs, typename... Os, typename... Ss>
+    static auto viewArchetype(
+        const Archetype &archetype,
+        impl::TypeList<Cs...>,
+        impl::TypeList<Os...>,
+        impl::TypeList<Ss...>
+    ) {
+      const auto &shape{archetype.runtimeStruct()};
+      std::tuple offsets{impl::componentOffset<Os>(shape)...};
+      std::tuple shared{archetype.template shared<Ss>()...};
+
+      return std::ranges::views::zip_transform(
+          [offsets, shared](Entity entity, SelectiveObjectRef<Cs...> obj) {
+            auto optionals{std::apply(
+                [&](const auto &...offset) {
+                  return std::tuple{
+                      (offset ? reinterpret_cast<Os *>(obj.data() + *offset)
+                              : nullptr)...
+                  };
+                },
+                offsets
+            )};
+            return QueryResult<Terms...>{
+                entity, impl::QueryRowFor<Terms...>{obj, optionals, shared}
+            };
+          },
+          archetype.entities(),
+          RuntimeVector::View<Cs...>{archetype.storage()}
+      );
+    }
 
   public:
-    SelectiveView() { m_Types.insert({typeid(Cs)...}); }
+    SelectiveView() { (impl::QueryTerm<Terms>::describe(m_Filter), ...); }
 
     bool matchesArchetype(const Archetype &archetype) const {
-      using std::cout;
-      using std::endl;
-
       const auto &shape{archetype.runtimeStruct()};
+      auto has{[&](std::type_index type) {
+        return impl::hasComponent(shape, type);
+      }};
 
-      cout << "Considering archetype:" << endl;
-      for (const auto &member : shape.Members)
-        cout << "  " << member.Field.TypeIndex.name() << endl;
-
-      auto matches{std::ranges::all_of(
-          m_Types,
-          [&](const std::type_index &type) {
-            return std::ranges::contains(
-                shape.Members,
-                type,
-                [](const RuntimeStruct::Member &member) {
-                  return member.Field.TypeIndex;
-                }
-            );
-          }
-      )};
-
-      cout << "    Matches? " << matches << endl;
-      return matches;
+      return std::ranges::all_of(m_Filter.Required, has) &&
+             std::ranges::none_of(m_Filter.Excluded, has) &&
+             std::ranges::all_of(m_Filter.AnyOf, [&](const auto &types) {
+               return std::ranges::any_of(types, has);
+             }) &&
+             std::ranges::all_of(m_Filter.Shared, [&](std::type_index type) {
+               return archetype.hasShared(type);
+             });
     }
 
     auto viewArchetype(const Archetype &archetype) const {
-      static_assert(std::ranges::viewable_range<RuntimeVector::View<Cs...>>);
-      static_assert(std::ranges::viewable_range<const std::vector<Entity> &>);
-      return std::ranges::views::zip_transform(
-          [](Entity entity, SelectiveObjectRef<Cs...> obj) {
-            return QueryResult<Cs...>(entity, obj);
-          },
-          archetype.entities(),
-          RuntimeVector::View<Cs...>{archetype.storage()}
+      return viewArchetype(
+          archetype,
+          typename impl::Concat<
+              typename impl::QueryTerm<Terms>::Required...>::Type{},
+          typename impl::Concat<
+              typename impl::QueryTerm<Terms>::Optional...>::Type{},
+          typename impl::Concat<
+              typename impl::QueryTerm<Terms>::Shared...>::Type{}
       );
     }
   };
 
   class View {
   public:
-    template <typename... Cs>
-    static SelectiveView<Cs...> withComponents() {
-      return SelectiveView<Cs...>{};
+    /**
+     * e.g. `withComponents<Position, Optional<Velocity>, Without<Frozen>>()`
+     * visits every entity with a Position that is not Frozen.
+     */
+    template <typename... Terms>
+    static SelectiveView<Terms...> withComponents() {
+      return SelectiveView<Terms...>{};
     }
   };
 
-  template <typename... Ts>
+  template <typename... Terms>
   struct QueryResult {
     Entity EntityID;
-    SelectiveObjectRef<Ts...> Components;
+    impl::QueryRowFor<Terms...> Components;
   };
 
 private:
-  std::pair<size_t, Archetype &>
-  findOrAddArchetype(const RuntimeStruct &requirements) {
+  std::pair<size_t, Archetype &> findOrAddArchetype(
+      const RuntimeStruct &requirements,
+      const std::vector<impl::SharedComponent> &shared = {}
+  ) {
     std::unordered_set<std::type_index> requiredFields;
     for (const RuntimeStruct::Member &member : requirements.Members)
       requiredFields.insert(member.Field.TypeIndex);
@@ -139,7 +719,8 @@ private:
     for (size_t index = 0; index < m_Archetypes.size(); ++index) {
       auto &archetype{m_Archetypes[index]};
       const auto &members{archetype.runtimeStruct().Members};
-      if (members.size() != requirements.Members.size())
+      if (members.size() != requirements.Members.size() ||
+          archetype.sharedComponents() != shared)
         continue;
       if (std::ranges::all_of(members, [&](auto &member) {
             return requiredFields.contains(member.Field.TypeIndex);
@@ -148,11 +729,195 @@ private:
     }
 
     size_t index{m_Archetypes.size()};
-    auto &archetype{m_Archetypes.emplace_back(requirements)};
+    auto &archetype{m_Archetypes.emplace_back(requirements, shared)};
+    ++m_ArchetypeVersion;
 
     return {index, archetype};
   }
 
+  /**
+   * Moves `entity` to the archetype of `shape` and `shared`, moving over the
+   * components both archetypes have. The caller constructs any new
+   * component. Neither argument may refer into an archetype.
+   */
+  std::pair<size_t, uint8_t *> migrateEntity(
+      Entity entity,
+      const RuntimeStruct &shape,
+      const std::vector<impl::SharedComponent> &shared
+  ) {
+    auto &location{m_Entities.at(entity)};
+    auto target{findOrAddArchetype(shape, shared).first};
+    if (target == location.ArchetypeID)
+      return {target, m_Archetypes[target].row(location.Index)};
+
+    auto &source{m_Archetypes[location.ArchetypeID]};
+    auto &destination{m_Archetypes[target]};
+
+    auto [index, _]{destination.add(entity)};
+    auto from{source.row(location.Index)};
+    auto to{destination.row(index)};
+    for (const auto &member : source.runtimeStruct().Members) {
+      auto field{member.Field.TypeIndex};
+      auto offset{std::ranges::find(
+          destination.runtimeStruct().Members,
+          field,
+          [](const RuntimeStruct::Member &other) {
+            return other.Field.TypeIndex;
+          }
+      )};
+      if (offset == destination.runtimeStruct().Members.end())
+        member.Field.DestructorFunction(from + member.Offset);
+      else
+        member.Field.MoveFunction(from + member.Offset, to + offset->Offset);
+    }
+
+    if (auto moved{source.eraseMoved(location.Index)})
+      m_Entities[*moved].Index = location.Index;
+    location = {.ArchetypeID = target, .Index = index};
+    return {target, to};
+  }
+
+  /** Removes an empty archetype, moving the last one into its place. */
+  void eraseArchetype(size_t id) {
+    auto last{m_Archetypes.size() - 1};
+    if (id != last) {
+      m_Archetypes[id] = std::move(m_Archetypes[last]);
+      for (auto entity : m_Archetypes[id].entities())
+        m_Entities[entity].ArchetypeID = id;
+    }
+    m_Archetypes.pop_back();
+    ++m_ArchetypeVersion;
+  }
+
+  template <typename T, typename Compare>
+  void sortArchetype(size_t id, Compare &compare) {
+    const auto &archetype{m_Archetypes[id]};
+    auto offset{impl::componentOffset<T>(archetype.runtimeStruct())};
+    if (!offset)
+      return;
+
+    auto key{[&](size_t row) -> const T & {
+      return *reinterpret_cast<const T *>(archetype.row(row) + *offset);
+    }};
+    std::vector<size_t> order(archetype.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::ranges::stable_sort(order, [&](size_t a, size_t b) {
+      return compare(key(a), key(b));
+    });
+    reorderArchetype(id, order);
+  }
+
+  /** Compaction pass over archetypes; see `compact`. */
+  template <typename F>
+  bool compactWithin(std::chrono::nanoseconds budget, F &&reorder) {
+    auto deadline{std::chrono::steady_clock::now() + budget};
+    do {
+      if (m_CompactionCursor >= m_Archetypes.size()) {
+        m_CompactionCursor = 0;
+        return true;
+      }
+
+      auto id{m_CompactionCursor};
+      if (m_Archetypes[id].size() == 0) {
+        // the archetype moved into this slot is visited next
+        eraseArchetype(id);
+        continue;
+      }
+      reorder(id);
+      if (m_Archetypes[id].overProvisioned())
+        m_Archetypes[id].shrinkToFit();
+      ++m_CompactionCursor;
+    } while (std::chrono::steady_clock::now() < deadline);
+    return false;
+  }
+
+  /** Applies `order`, the old row of each new row, to an archetype. */
+  /** Updates every index on the components of `entity`, if it is alive. */
+  void reindexAll(Entity entity) {
+    auto it{m_Entities.find(entity)};
+    if (it == m_Entities.end())
+      return;
+    const auto &archetype{m_Archetypes[it->second.ArchetypeID]};
+    auto *row{archetype.row(it->second.Index)};
+    for (const auto &member : archetype.runtimeStruct().Members) {
+      auto indexes{m_Indexes.find(member.Field.TypeIndex)};
+      if (indexes == m_Indexes.end())
+        continue;
+      for (const auto &valueIndex : indexes->second)
+        valueIndex->update(entity, row + member.Offset);
+    }
+  }
+
+  void reorderArchetype(size_t id, const std::vector<size_t> &order) {
+    auto &archetype{m_Archetypes[id]};
+    std::vector<bool> placed(order.size());
+    for (size_t start{0}; start < order.size(); ++start) {
+      // rotate each cycle of the permutation into place with swaps
+      for (auto row{start}; !placed[row]; row = order[row]) {
+        placed[row] = true;
+        if (order[row] != start)
+          archetype.swap(row, order[row]);
+      }
+    }
+
+    for (size_t row{0}; row < archetype.size(); ++row) {
+      if (order[row] != row)
+        m_Entities[archetype.entities()[row]].Index = row;
+    }
+  }
+
+  /**
+   * Sorts the rows of an archetype with a T by `compare`, doing work in
+   * proportion to the rows out of order: rows already in order are only
+   * compared with their neighbour, and each row out of order is placed by
+   * binary search among the rows before it.
+   */
+  template <typename T, typename Compare>
+  void restoreOrder(size_t id, Compare &compare) {
+    const auto &archetype{m_Archetypes[id]};
+    auto offset{*impl::componentOffset<T>(archetype.runtimeStruct())};
+    auto precedes{[&](size_t a, size_t b) {
+      return compare(
+          *reinterpret_cast<const T *>(archetype.row(a) + offset),
+          *reinterpret_cast<const T *>(archetype.row(b) + offset)
+      );
+    }};
+
+    size_t first{1};
+    while (first < archetype.size() && !precedes(first, first - 1))
+      ++first;
+    if (first >= archetype.size())
+      return;
+
+    std::vector<size_t> order(archetype.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    for (auto i{first}; i < order.size(); ++i) {
+      auto row{order[i]};
+      if (!precedes(row, order[i - 1]))
+        continue;
+      // after the rows that compare equal, so the sort is stable
+      auto end{order.begin() + static_cast<std::ptrdiff_t>(i)};
+      auto position{std::upper_bound(order.begin(), end, row, precedes)};
+      std::move_backward(position, end, end + 1);
+      *position = row;
+    }
+    reorderArchetype(id, order);
+  }
+
+  /** The observers of `type`, or null if it has none. */
+  std::vector<std::unique_ptr<impl::EventRecorder>> *
+  observersOf(std::type_index type) {
+    auto it{m_Observers.find(type)};
+    return it == m_Observers.end() ? nullptr : &it->second;
+  }
+
+  void notify(std::type_index type, impl::ComponentEvent event, Entity entity) {
+    if (auto *observers{observersOf(type)}) {
+      for (const auto &observer : *observers)
+        observer->record(event, entity);
+    }
+  }
+
 public:
   std::pair<Entity, RawObjectPtr> createEntity(const RuntimeStruct &shape) {
     auto entity{++m_NextEntity};
@@ -165,10 +930,483 @@ public:
     auto [index, obj] = archetype.add(entity);
 
     m_Entities[entity] = AliveEntity{.ArchetypeID = id, .Index = index};
+    for (const auto &member : shape.Members)
+      notify(member.Field.TypeIndex, impl::ComponentEvent::Added, entity);
 
     return {entity, obj};
   }
 
+  /** Creates an entity with `components`, adding it to their indexes. */
+  template <typename... Ts>
+  Entity createEntityWith(Ts &&...components) {
+    RuntimeStruct shape{};
+    ((shape = shape.withMember<std::decay_t<Ts>>()), ...);
+    auto [entity, object]{createEntity(shape)};
+    (
+        object.select<std::decay_t<Ts>>()->template emplaceField<
+            std::decay_t<Ts>>(std::forward<Ts>(components)),
+        ...
+    );
+    (reindex<std::decay_t<Ts>>(entity), ...);
+    return entity;
+  }
+
+  /**
+   * Creates `count` entities with copies of the components of `prefab`. The
+   * rows are appended to their archetype in one go, and copied with memcpy
+   * where the components allow it. Returns the new entities, which are
+   * numbered consecutively.
+   */
+  std::ranges::iota_view<Entity, Entity>
+  instantiate(const Prefab &prefab, size_t count) {
+    const auto &shape{prefab.runtimeStruct()};
+    auto entities{std::views::iota(m_NextEntity + 1, m_NextEntity + 1 + count)};
+    m_NextEntity += count;
+
+    auto [id, archetype]{findOrAddArchetype(shape)};
+    auto first{archetype.add(entities)};
+    prefab.cloneInto(archetype.row(first), count);
+    for (size_t i{0}; i < count; ++i)
+      m_Entities[entities[i]] = {.ArchetypeID = id, .Index = first + i};
+
+    for (const auto &member : archetype.runtimeStruct().Members) {
+      if (auto *observers{observersOf(member.Field.TypeIndex)}) {
+        for (const auto &observer : *observers) {
+          for (auto entity : entities)
+            observer->record(impl::ComponentEvent::Added, entity);
+        }
+      }
+
+      auto indexes{m_Indexes.find(member.Field.TypeIndex)};
+      if (indexes == m_Indexes.end())
+        continue;
+      for (size_t i{0}; i < count; ++i) {
+        auto *component{archetype.row(first + i) + member.Offset};
+        for (const auto &valueIndex : indexes->second)
+          valueIndex->update(entities[i], component);
+      }
+    }
+    return entities;
+  }
+
+  /**
+   * Like `instantiate(prefab, count)`, then runs `customize(Entity,
+   * RawObjectPtr)` on each new entity for per-instance overrides, and
+   * reindexes its components. The entities are fully created by then, so
+   * `customize` may add or remove components, which moves entities.
+   */
+  template <typename F>
+  std::ranges::iota_view<Entity, Entity>
+  instantiate(const Prefab &prefab, size_t count, F &&customize) {
+    auto entities{instantiate(prefab, count)};
+    for (auto entity : entities) {
+      // looked up each time, as earlier calls may have moved or destroyed it
+      auto it{m_Entities.find(entity)};
+      if (it == m_Entities.end())
+        continue;
+      auto [id, index]{it->second};
+      customize(entity, m_Archetypes[id].get(index));
+      reindexAll(entity);
+    }
+    return entities;
+  }
+
+  /** A prefab of copies of the components of `entity`. */
+  [[nodiscard]] Prefab prefabOf(Entity entity) const {
+    const auto &location{m_Entities.at(entity)};
+    const auto &archetype{m_Archetypes[location.ArchetypeID]};
+    return Prefab::copyOf(
+        archetype.runtimeStruct(), archetype.row(location.Index)
+    );
+  }
+
+  /**
+   * Destroys the components of `entity`, removing it from every index and
+   * relation pair it is part of. Returns false if it did not exist.
+   */
+  bool destroyEntity(Entity entity) {
+    auto it{m_Entities.find(entity)};
+    if (it == m_Entities.end())
+      return false;
+
+    auto [id, index]{it->second};
+    auto &archetype{m_Archetypes[id]};
+    auto *row{archetype.row(index)};
+    for (const auto &member : archetype.runtimeStruct().Members) {
+      if (auto indexes{m_Indexes.find(member.Field.TypeIndex)};
+          indexes != m_Indexes.end()) {
+        for (const auto &valueIndex : indexes->second)
+          valueIndex->erase(entity);
+      }
+      notify(member.Field.TypeIndex, impl::ComponentEvent::Removed, entity);
+      member.Field.DestructorFunction(row + member.Offset);
+    }
+    if (auto moved{archetype.eraseMoved(index)})
+      m_Entities[*moved].Index = index;
+    m_Entities.erase(it);
+
+    for (auto &[_, relation] : m_Relations)
+      relation.forget(entity);
+    return true;
+  }
+
+  [[nodiscard]] bool contains(Entity entity) const {
+    return m_Entities.contains(entity);
+  }
+
+  /**
+   * Adds the pair (R, target) to `source`, e.g. `relate<OwnedBy>(item,
+   * player)`. Pairs live in an index beside the archetypes, so relating
+   * does not move entities, and are removed when either entity is
+   * destroyed. Returns false if the pair already existed.
+   */
+  template <typename R>
+  bool relate(Entity source, Entity target) {
+    if (!contains(source) || !contains(target))
+      throw std::out_of_range("cannot relate an entity that does not exist");
+    return m_Relations[typeid(R)].add(source, target);
+  }
+
+  /** Removes the pair (R, target) from `source`, if it has it. */
+  template <typename R>
+  bool unrelate(Entity source, Entity target) {
+    auto it{m_Relations.find(typeid(R))};
+    return it != m_Relations.end() && it->second.remove(source, target);
+  }
+
+  template <typename R>
+  [[nodiscard]] bool hasRelation(Entity source, Entity target) const {
+    auto it{m_Relations.find(typeid(R))};
+    return it != m_Relations.end() && it->second.contains(source, target);
+  }
+
+  /**
+   * The entities with the pair (R, target), in the order they were related.
+   * The span is invalidated by the next change to R.
+   */
+  template <typename R>
+  [[nodiscard]] std::span<const Entity> sources(Entity target) const {
+    auto it{m_Relations.find(typeid(R))};
+    if (it == m_Relations.end())
+      return {};
+    return it->second.sources(target);
+  }
+
+  /** The targets of the R pairs of `source`; see `sources`. */
+  template <typename R>
+  [[nodiscard]] std::span<const Entity> targets(Entity source) const {
+    auto it{m_Relations.find(typeid(R))};
+    if (it == m_Relations.end())
+      return {};
+    return it->second.targets(source);
+  }
+
+  [[nodiscard]] const std::vector<Archetype> &archetypes() const {
+    return m_Archetypes;
+  }
+
+  /**
+   * Changes whenever archetypes are added or removed, which moves others to
+   * new positions; anything caching archetypes or their positions must be
+   * rebuilt when it does.
+   */
+  [[nodiscard]] size_t archetypeVersion() const { return m_ArchetypeVersion; }
+
+  /**
+   * Runs the compaction pass for about `budget`, resuming where the last
+   * call stopped, e.g. in idle frames. Empty archetypes are freed, and
+   * storage holding more than twice its rows shrinks to fit. Returns true
+   * when the pass has gone over every archetype, after which the next call
+   * starts over. Each call makes progress, however small the budget.
+   */
+  bool compact(std::chrono::nanoseconds budget) {
+    return compactWithin(budget, [](size_t) {});
+  }
+
+  /**
+   * Like `compact`, also sorting the rows of the archetypes with a T by
+   * `compare(const T&, const T&)`, so iteration follows that order.
+   */
+  template <typename T, typename Compare = std::less<>>
+  bool compact(std::chrono::nanoseconds budget, Compare compare = {}) {
+    return compactWithin(budget, [&](size_t id) {
+      sortArchetype<T>(id, compare);
+    });
+  }
+
+  /** The T of `entity`, or null if it has none or does not exist. */
+  template <typename T>
+  [[nodiscard]] T *get(Entity entity) const {
+    auto it{m_Entities.find(entity)};
+    if (it == m_Entities.end())
+      return nullptr;
+
+    const auto &archetype{m_Archetypes[it->second.ArchetypeID]};
+    auto offset{impl::componentOffset<T>(archetype.runtimeStruct())};
+    if (!offset)
+      return nullptr;
+    return reinterpret_cast<T *>(archetype.row(it->second.Index) + *offset);
+  }
+
+  /**
+   * Gives `entity` a T constructed from `args`, replacing any it had. Adding
+   * moves the entity to another archetype, which invalidates pointers to its
+   * components and to those of the entity that takes over its old row.
+   */
+  template <typename T, typename... Args>
+  T &add(Entity entity, Args &&...args) {
+    if (auto *existing{get<T>(entity)}) {
+      *existing = T(std::forward<Args>(args)...);
+      reindex<T>(entity);
+      notify(typeid(T), impl::ComponentEvent::Set, entity);
+      return *existing;
+    }
+
+    const auto &archetype{m_Archetypes[m_Entities.at(entity).ArchetypeID]};
+    auto shape{archetype.runtimeStruct().template withMember<T>()};
+    auto shared{archetype.sharedComponents()};
+    auto [id, object]{migrateEntity(entity, shape, shared)};
+
+    auto offset{*impl::componentOffset<T>(m_Archetypes[id].runtimeStruct())};
+    auto &component{*new (object + offset) T(std::forward<Args>(args)...)};
+    reindex<T>(entity);
+    notify(typeid(T), impl::ComponentEvent::Added, entity);
+    return component;
+  }
+
+  /** Destroys the T of `entity`, if it has one; see `add`. */
+  template <typename T>
+  void remove(Entity entity) {
+    if (get<T>(entity) == nullptr)
+      return;
+
+    if (auto indexes{m_Indexes.find(typeid(T))}; indexes != m_Indexes.end()) {
+      for (const auto &valueIndex : indexes->second)
+        valueIndex->erase(entity);
+    }
+    notify(typeid(T), impl::ComponentEvent::Removed, entity);
+
+    const auto &archetype{m_Archetypes[m_Entities.at(entity).ArchetypeID]};
+    std::set<RuntimeField> fields;
+    for (const auto &member : archetype.runtimeStruct().Members) {
+      if (member.Field.TypeIndex != typeid(T))
+        fields.insert(member.Field);
+    }
+    auto shared{archetype.sharedComponents()};
+    migrateEntity(entity, RuntimeStruct{fields}, shared);
+  }
+
+  /**
+   * Sets the shared T of `entity` to `value`. Rather than in every row,
+   * shared values are stored once per archetype, so entities with equal
+   * values sit together in one archetype and those with different values
+   * in different ones. T must be equality comparable.
+   */
+  template <typename T>
+  void setShared(Entity entity, T value) {
+    const auto &archetype{m_Archetypes[m_Entities.at(entity).ArchetypeID]};
+    auto component{impl::SharedComponent::of(std::move(value))};
+    // reuse the copy of archetypes that already share an equal value
+    for (const auto &other : m_Archetypes) {
+      auto equal{std::ranges::find(other.sharedComponents(), component)};
+      if (equal != other.sharedComponents().end()) {
+        component = *equal;
+        break;
+      }
+    }
+
+    auto shared{archetype.sharedComponents()};
+    std::erase_if(shared, [](const impl::SharedComponent &existing) {
+      return existing.Type == typeid(T);
+    });
+    shared.insert(
+        std::ranges::upper_bound(
+            shared, component.Type, {}, &impl::SharedComponent::Type
+        ),
+        std::move(component)
+    );
+    auto shape{archetype.runtimeStruct()};
+    migrateEntity(entity, shape, shared);
+  }
+
+  /** The shared T of `entity`, or null if it has none. */
+  template <typename T>
+  [[nodiscard]] const T *getShared(Entity entity) const {
+    auto it{m_Entities.find(entity)};
+    if (it == m_Entities.end())
+      return nullptr;
+    return m_Archetypes[it->second.ArchetypeID].template shared<T>();
+  }
+
+  template <typename T>
+  void removeShared(Entity entity) {
+    if (getShared<T>(entity) == nullptr)
+      return;
+
+    const auto &archetype{m_Archetypes[m_Entities.at(entity).ArchetypeID]};
+    auto shared{archetype.sharedComponents()};
+    std::erase_if(shared, [](const impl::SharedComponent &existing) {
+      return existing.Type == typeid(T);
+    });
+    auto shape{archetype.runtimeStruct()};
+    migrateEntity(entity, shape, shared);
+  }
+
+  /**
+   * Creates the world's only T from `args`, replacing any it had, for state
+   * that belongs to no entity, e.g. the active camera.
+   */
+  template <typename T, typename... Args>
+  T &setSingleton(Args &&...args) {
+    auto value{std::make_shared<T>(std::forward<Args>(args)...)};
+    auto &reference{*value};
+    m_Singletons[typeid(T)] = std::move(value);
+    return reference;
+  }
+
+  /** The world's T, or null if it has none. */
+  template <typename T>
+  [[nodiscard]] T *singleton() const {
+    auto it{m_Singletons.find(typeid(T))};
+    if (it == m_Singletons.end())
+      return nullptr;
+    return static_cast<T *>(it->second.get());
+  }
+
+  template <typename T>
+  void removeSingleton() {
+    m_Singletons.erase(typeid(T));
+  }
+
+  /**
+   * Indexes every T by `keyOf(const T &)`, e.g. `addIndex<PlayerId>(
+   * [](const PlayerId &id) { return id.Value; })`, and keeps the index
+   * current through `createEntityWith`, `add`, `modify`, `remove` and
+   * `destroyEntity`. Ts written any other way need a call to `reindex`.
+   * The index lives as long as the world.
+   */
+  template <typename T, typename F>
+  auto &addIndex(F keyOf) {
+    using Key = std::decay_t<std::invoke_result_t<F, const T &>>;
+    auto index{std::make_unique<ValueIndex<T, Key>>(std::move(keyOf))};
+    auto &reference{*index};
+    for (auto [entity, components] : query(View::withComponents<T>()))
+      reference.update(entity, &components.template getField<T>());
+    m_Indexes[typeid(T)].push_back(std::move(index));
+    return reference;
+  }
+
+  /**
+   * Records when Ts are added, set or removed, and dispatches the records on
+   * `bus` at the next `flushEvents` as batches of ComponentAdded<T>,
+   * ComponentSet<T> and ComponentRemoved<T>. Nothing runs while storage is
+   * being changed, and events only cost a push until they are flushed.
+   * Any bus flavor works; a `StaticBus` must carry the three event types.
+   */
+  template <typename T, typename B>
+    requires std::derived_from<B, core::HandlerRegistry<typename B::Context>>
+  void observe(B &bus) {
+    using C = typename B::Context;
+    m_Observers[typeid(T)].push_back(
+        std::make_unique<ComponentObserver<T, C, B>>(bus)
+    );
+  }
+
+  /**
+   * Sync point: dispatches the events recorded since the last flush to the
+   * buses of context type C. Events raised by handlers wait for the next
+   * flush. By then, removed components and destroyed entities are gone.
+   */
+  template <typename C>
+  void flushEvents(C &context) {
+    for (auto &[_, observers] : m_Observers) {
+      for (const auto &observer : observers)
+        observer->flush(typeid(C), &context);
+    }
+  }
+
+  /** Calls `modify(T &)` on the T of `entity`, then reindexes it. */
+  template <typename T, typename F>
+  void modify(Entity entity, F &&modify) {
+    auto *component{get<T>(entity)};
+    if (component == nullptr)
+      return;
+    std::forward<F>(modify)(*component);
+    reindex<T>(entity);
+    notify(typeid(T), impl::ComponentEvent::Set, entity);
+  }
+
+  /** Updates the indexes on T after the T of `entity` was written. */
+  template <typename T>
+  void reindex(Entity entity) {
+    auto indexes{m_Indexes.find(typeid(T))};
+    if (indexes == m_Indexes.end())
+      return;
+    if (auto *component{get<T>(entity)}) {
+      for (const auto &valueIndex : indexes->second)
+        valueIndex->update(entity, component);
+    }
+  }
+
+  /**
+   * Stably sorts the rows of every archetype with a T by
+   * `compare(const T&, const T&)`, so systems visit entities in that order.
+   */
+  template <typename T, typename Compare = std::less<>>
+  void sortArchetypes(Compare compare = {}) {
+    for (size_t id{0}; id < m_Archetypes.size(); ++id)
+      sortArchetype<T>(id, compare);
+  }
+
+  /**
+   * Sort policy: sorts the rows of every archetype with a T by
+   * `compare(const T&, const T&)` now, and again at each `maintainOrder`.
+   * An archetype with components of several policies follows the first one
+   * set. Setting a policy for T again replaces it.
+   */
+  template <typename T, typename Compare = std::less<>>
+  void sortBy(Compare compare = {}) {
+    std::erase_if(m_SortPolicies, [](const auto &policy) {
+      return policy.first == typeid(T);
+    });
+    m_SortPolicies.emplace_back(
+        typeid(T),
+        [compare](World &world, size_t id) mutable {
+          const auto &shape{world.m_Archetypes[id].runtimeStruct()};
+          if (!impl::componentOffset<T>(shape))
+            return false;
+          world.restoreOrder<T>(id, compare);
+          return true;
+        }
+    );
+    maintainOrder();
+  }
+
+  template <typename T>
+  void removeSortPolicy() {
+    std::erase_if(m_SortPolicies, [](const auto &policy) {
+      return policy.first == typeid(T);
+    });
+  }
+
+  /**
+   * Puts rows that fell out of the order of their sort policy, after being
+   * created, moved or modified, back in place. Meant to run every frame: an
+   * archetype still in order costs one comparison per row, and one with a
+   * few rows out of order moves only the rows between their old and new
+   * places.
+   */
+  void maintainOrder() {
+    if (m_SortPolicies.empty())
+      return;
+    for (size_t id{0}; id < m_Archetypes.size(); ++id) {
+      for (const auto &[_, restore] : m_SortPolicies) {
+        if (restore(*this, id))
+          break;
+      }
+    }
+  }
+
   RawObjectPtr getEntity(Entity id) const {
     auto it{m_Entities.find(id)};
     if (it == m_Entities.end()) {
@@ -179,13 +1417,14 @@ public:
     return archetype.get(it->second.Index);
   }
 
+  /** The view is copied, so it may be a temporary. */
   template <typename V>
   auto query(const V &view) const {
     return m_Archetypes |
-           std::ranges::views::filter([&](const Archetype &archetype) {
+           std::ranges::views::filter([view](const Archetype &archetype) {
              return view.matchesArchetype(archetype);
            }) |
-           std::ranges::views::transform([&](const Archetype &archetype) {
+           std::ranges::views::transform([view](const Archetype &archetype) {
              return view.viewArchetype(archetype);
            }) |
            std::ranges::views::join;
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <solaris/framework/ecs.hpp>
+#include <solaris/math/matrix.hpp>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace solaris {
+/**
+ * Place of an entity in a hierarchy; entities without a parent are roots.
+ * `Order` is the position of the entity in a depth-first walk over every
+ * hierarchy, which `hierarchy::propagateTransforms` maintains.
+ */
+struct Hierarchy {
+  Entity Parent{NoEntity};
+  std::vector<Entity> Children{};
+  size_t Order{0};
+};
+
+/** Transform relative to the parent, or to the world for roots. */
+struct LocalTransform {
+  Matrix4f Matrix{matrix::identity<float, 4>()};
+};
+
+struct WorldTransform {
+  Matrix4f Matrix{matrix::identity<float, 4>()};
+};
+
+namespace hierarchy {
+/** Removes `child` from the children of its parent, making it a root. */
+inline void detach(World &world, Entity child) {
+  auto *node{world.get<Hierarchy>(child)};
+  if (node == nullptr || node->Parent == NoEntity)
+    return;
+
+  if (auto *parent{world.get<Hierarchy>(node->Parent)})
+    std::erase(parent->Children, child);
+  node->Parent = NoEntity;
+}
+
+/**
+ * Attaches `child` under `parent`, giving either a Hierarchy if needed.
+ * Throws `std::invalid_argument` if `child` is an ancestor of `parent`.
+ */
+inline void setParent(World &world, Entity child, Entity parent) {
+  for (auto ancestor{parent}; ancestor != NoEntity;) {
+    if (ancestor == child)
+      throw std::invalid_argument("an entity cannot be its own ancestor");
+    auto *node{world.get<Hierarchy>(ancestor)};
+    ancestor = node != nullptr ? node->Parent : NoEntity;
+  }
+
+  detach(world, child);
+  // adding components moves entities, so look both up afterwards
+  for (auto entity : {child, parent}) {
+    if (world.get<Hierarchy>(entity) == nullptr)
+      world.add<Hierarchy>(entity);
+  }
+  world.get<Hierarchy>(child)->Parent = parent;
+  world.get<Hierarchy>(parent)->Children.push_back(child);
+}
+
+/**
+ * Renumbers every hierarchy depth-first and sorts the rows of each archetype
+ * by that order, so parents come before their children.
+ */
+inline void sortDepthFirst(World &world) {
+  std::vector<Entity> pending;
+  for (auto [entity, components] :
+       world.query(World::View::withComponents<Hierarchy>())) {
+    auto &parent{components.getField<Hierarchy>().Parent};
+    // children of destroyed entities become roots
+    if (parent != NoEntity && world.get<Hierarchy>(parent) == nullptr)
+      parent = NoEntity;
+    if (parent == NoEntity)
+      pending.push_back(entity);
+  }
+  std::ranges::reverse(pending);
+
+  size_t order{0};
+  while (!pending.empty()) {
+    auto *node{world.get<Hierarchy>(pending.back())};
+    pending.pop_back();
+    node->Order = order++;
+    // destroying an entity leaves it in the children of its parent
+    std::erase_if(node->Children, [&](Entity child) {
+      return world.get<Hierarchy>(child) == nullptr;
+    });
+    pending.insert(
+        pending.end(), node->Children.rbegin(), node->Children.rend()
+    );
+  }
+
+  world.sortArchetypes<Hierarchy>([](const auto &a, const auto &b) {
+    return a.Order < b.Order;
+  });
+}
+
+namespace impl {
+/** Rows of an archetype with a Hierarchy, with its component offsets. */
+struct HierarchyCursor {
+  const Archetype *Rows;
+  size_t Next;
+  size_t Node;
+  std::optional<size_t> Local;
+  std::optional<size_t> World;
+};
+
+/**
+ * Visits the hierarchy rows of every archetype merged by `Order`, keeping
+ * the world transforms of the current node's ancestors on a stack. Returns
+ * false, if `strict`, when a node comes before its parent.
+ */
+inline bool propagateInOrder(World &world, bool strict) {
+  std::vector<HierarchyCursor> cursors;
+  for (const auto &archetype : world.archetypes()) {
+    const auto &shape{archetype.runtimeStruct()};
+    auto node{solaris::impl::componentOffset<Hierarchy>(shape)};
+    if (node && archetype.size() > 0) {
+      cursors.push_back({
+          .Rows = &archetype,
+          .Next = 0,
+          .Node = *node,
+          .Local = solaris::impl::componentOffset<LocalTransform>(shape),
+          .World = solaris::impl::componentOffset<WorldTransform>(shape),
+      });
+    }
+  }
+
+  std::vector<std::pair<Entity, Matrix4f>> ancestors;
+  while (true) {
+    HierarchyCursor *cursor{nullptr};
+    auto order{std::numeric_limits<size_t>::max()};
+    for (auto &candidate : cursors) {
+      if (candidate.Next == candidate.Rows->size())
+        continue;
+      auto *row{candidate.Rows->row(candidate.Next)};
+      const auto &node{*reinterpret_cast<Hierarchy *>(row + candidate.Node)};
+      if (cursor == nullptr || node.Order < order) {
+        cursor = &candidate;
+        order = node.Order;
+      }
+    }
+    if (cursor == nullptr)
+      return true;
+
+    auto entity{cursor->Rows->entities()[cursor->Next]};
+    auto *row{cursor->Rows->row(cursor->Next++)};
+    const auto &node{*reinterpret_cast<Hierarchy *>(row + cursor->Node)};
+
+    while (!ancestors.empty() && ancestors.back().first != node.Parent)
+      ancestors.pop_back();
+    if (node.Parent != NoEntity && ancestors.empty() && strict)
+      return false;
+
+    auto transform{matrix::identity<float, 4>()};
+    if (cursor->Local)
+      transform = reinterpret_cast<LocalTransform *>(row + *cursor->Local)
+                      ->Matrix;
+    if (!ancestors.empty())
+      transform = ancestors.back().second * transform;
+    if (cursor->World) {
+      auto *output{reinterpret_cast<WorldTransform *>(row + *cursor->World)};
+      output->Matrix = transform;
+    }
+    ancestors.emplace_back(entity, transform);
+  }
+}
+} // namespace impl
+
+/**
+ * Computes the WorldTransform of every entity. Entities with a Hierarchy are
+ * visited in a single pass over storage that is kept in depth-first order,
+ * where each node finds its parent's transform on a stack instead of looking
+ * it up. Storage is only re-sorted when nodes were added or reparented since.
+ */
+inline void propagateTransforms(World &world) {
+  auto unparented{World::View::withComponents<
+      LocalTransform,
+      WorldTransform,
+      Without<Hierarchy>>()};
+  for (auto [_, components] : world.query(unparented)) {
+    components.getField<WorldTransform>().Matrix =
+        components.getField<LocalTransform>().Matrix;
+  }
+
+  if (impl::propagateInOrder(world, true))
+    return;
+  sortDepthFirst(world);
+  impl::propagateInOrder(world, false);
+}
+} // namespace hierarchy
+} // namespace solaris
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <solaris/framework/runtime_vector.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace solaris {
+/**
+ * Fully constructed prototype of an entity, which `World::instantiate`
+ * clones into as many entities as needed.
+ */
+class Prefab {
+  std::unique_ptr<RuntimeVector> m_Row;
+
+  explicit Prefab(const RuntimeStruct &shape)
+      : m_Row{std::make_unique<RuntimeVector>(shape)} {
+    m_Row->pushBack();
+  }
+
+public:
+  /** A prefab of copies of `components`. */
+  template <typename... Ts>
+  static Prefab of(Ts &&...components) {
+    Prefab prefab{RuntimeStruct::withMembers<std::decay_t<Ts>...>()};
+    auto object{prefab.prototype()};
+    (
+        object.select<std::decay_t<Ts>>()->template emplaceField<
+            std::decay_t<Ts>>(std::forward<Ts>(components)),
+        ...
+    );
+    return prefab;
+  }
+
+  /** A prefab of copies of the object at `source`, of shape `shape`. */
+  static Prefab copyOf(const RuntimeStruct &shape, uint8_t *source) {
+    Prefab prefab{shape};
+    auto *destination{prefab.m_Row->data()};
+    for (const auto &member : shape.Members) {
+      member.Field.CopyFunction(
+          source + member.Offset, destination + member.Offset
+      );
+    }
+    return prefab;
+  }
+
+  Prefab(Prefab &&) = default;
+  Prefab &operator=(Prefab &&) = default;
+
+  [[nodiscard]] const RuntimeStruct &runtimeStruct() const {
+    return m_Row->runtimeStruct();
+  }
+
+  /** The prototype, whose components may be changed in place. */
+  [[nodiscard]] RawObjectPtr prototype() const { return (*m_Row)[0]; }
+
+  /**
+   * Copy-constructs `count` objects of the prototype at `destination`, one
+   * `Stride` apart. When every field is trivially copyable the copies are
+   * made by a few memcpy calls over the whole range.
+   */
+  void cloneInto(uint8_t *destination, size_t count) const {
+    const auto &shape{runtimeStruct()};
+    auto *source{m_Row->data()};
+    if (count == 0)
+      return;
+
+    if (std::ranges::all_of(shape.Members, [](const auto &member) {
+          return member.Field.TriviallyCopyable;
+        })) {
+      // copy one object, then double the copied range until it is full
+      std::memcpy(destination, source, shape.Stride);
+      for (size_t copied{1}; copied < count;) {
+        auto batch{std::min(copied, count - copied)};
+        std::memcpy(
+            destination + copied * shape.Stride,
+            destination,
+            batch * shape.Stride
+        );
+        copied += batch;
+      }
+      return;
+    }
+
+    for (size_t i{0}; i < count; ++i) {
+      auto *object{destination + i * shape.Stride};
+      for (const auto &member : shape.Members) {
+        if (member.Field.TriviallyCopyable) {
+          std::memcpy(
+              object + member.Offset, source + member.Offset, member.Field.Size
+          );
+        } else {
+          member.Field.CopyFunction(
+              source + member.Offset, object + member.Offset
+          );
+        }
+      }
+    }
+  }
+};
+} // namespace solaris
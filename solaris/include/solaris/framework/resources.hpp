@@ -1,7 +1,176 @@
 #pragma once
 #include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <typeinfo>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * When enabled, borrows record themselves on the resource they borrow and
+ * throw `std::logic_error` on conflicting access. Defaults to debug builds.
+ */
+#ifndef SOLARIS_CHECK_BORROWS
+#ifdef NDEBUG
+#define SOLARIS_CHECK_BORROWS 0
+#else
+#define SOLARIS_CHECK_BORROWS 1
+#endif
+#endif
 
 namespace solaris::framework {
+namespace impl {
+inline size_t nextResourceTypeID() {
+  static std::atomic<size_t> counter{0};
+  return counter++;
+}
+
+/** Dense index of a resource type, used as its slot in `Resources`. */
+template <typename T>
+size_t resourceTypeID() {
+  static const size_t id{nextResourceTypeID()};
+  return id;
+}
+
+/** Number of readers, or -1 while written. */
+using BorrowState = std::atomic<int32_t>;
+
+inline void acquireShared(BorrowState *state) {
+  if (state == nullptr)
+    return;
+  auto current{state->load(std::memory_order_relaxed)};
+  do {
+    if (current < 0)
+      throw std::logic_error("resource is already borrowed for writing");
+  } while (!state->compare_exchange_weak(
+      current, current + 1, std::memory_order_acquire, std::memory_order_relaxed
+  ));
+}
+
+inline void acquireExclusive(BorrowState *state) {
+  if (state == nullptr)
+    return;
+  int32_t expected{0};
+  if (!state->compare_exchange_strong(
+          expected, -1, std::memory_order_acquire
+      )) {
+    throw std::logic_error(
+        expected < 0 ? "resource is already borrowed for writing"
+                     : "resource is already borrowed for reading"
+    );
+  }
+}
+} // namespace impl
+
+/**
+ * Scoped access to a resource: shared when T is const, exclusive otherwise.
+ * Only checked when `SOLARIS_CHECK_BORROWS` is enabled.
+ */
+template <typename T>
+class Borrow {
+  static constexpr bool Exclusive{!std::is_const_v<T>};
+
+  T *m_Resource;
+  impl::BorrowState *m_State;
+
+public:
+  Borrow(T &resource, impl::BorrowState *state)
+      : m_Resource{&resource}, m_State{state} {
+    if constexpr (Exclusive)
+      impl::acquireExclusive(m_State);
+    else
+      impl::acquireShared(m_State);
+  }
+
+  Borrow(Borrow &&other) noexcept
+      : m_Resource{other.m_Resource},
+        m_State{std::exchange(other.m_State, nullptr)} {}
+
+  Borrow(const Borrow &) = delete;
+  Borrow &operator=(const Borrow &) = delete;
+  Borrow &operator=(Borrow &&) = delete;
+
+  ~Borrow() {
+    if (m_State == nullptr)
+      return;
+    if constexpr (Exclusive)
+      m_State->store(0, std::memory_order_release);
+    else
+      m_State->fetch_sub(1, std::memory_order_release);
+  }
+
+  T &operator*() const { return *m_Resource; }
+
+  T *operator->() const { return m_Resource; }
+};
+
+template <typename T>
+using ReadBorrow = Borrow<const T>;
+
+template <typename T>
+using WriteBorrow = Borrow<T>;
+
+/** Declares shared access to a resource of type T. */
+template <typename T>
+struct Read {
+  using Resource = T;
+  using Borrow = ReadBorrow<T>;
+  static constexpr bool Exclusive{false};
+};
+
+/** Declares exclusive access to a resource of type T. */
+template <typename T>
+struct Write {
+  using Resource = T;
+  using Borrow = WriteBorrow<T>;
+  static constexpr bool Exclusive{true};
+};
+
+template <typename A>
+concept ResourceAccess = requires {
+  typename A::Resource;
+  typename A::Borrow;
+  { A::Exclusive } -> std::convertible_to<bool>;
+};
+
+/** The resources a system reads and writes, by resource type id. */
+class AccessSet {
+  std::vector<size_t> m_Reads{};
+  std::vector<size_t> m_Writes{};
+
+  static bool overlaps(
+      const std::vector<size_t> &left, const std::vector<size_t> &right
+  ) {
+    return std::ranges::any_of(left, [&right](size_t id) {
+      return std::ranges::contains(right, id);
+    });
+  }
+
+public:
+  template <ResourceAccess... As>
+  static AccessSet of() {
+    AccessSet access{};
+    (
+        (As::Exclusive ? access.m_Writes : access.m_Reads)
+            .push_back(impl::resourceTypeID<typename As::Resource>()),
+        ...
+    );
+    return access;
+  }
+
+  /** Whether running both at the same time could race. */
+  [[nodiscard]] bool conflictsWith(const AccessSet &other) const {
+    return overlaps(m_Writes, other.m_Writes) ||
+           overlaps(m_Writes, other.m_Reads) ||
+           overlaps(m_Reads, other.m_Writes);
+  }
+};
+
 template <typename T>
 class ResourceOwner {
   T m_Resource;
@@ -10,31 +179,127 @@ public:
   virtual ~ResourceOwner() = default;
 
   explicit ResourceOwner(T &&resource) : m_Resource{std::move(resource)} {}
+  ResourceOwner(ResourceOwner &&) = default;
 
   T &getResource() { return m_Resource; }
 };
 
+/**
+ * Type-indexed view of a set of resources. Every resource type has a dense
+ * id, so looking one up is a single indexed load.
+ */
 class Resources {
+  std::vector<void *> m_Slots{};
+  std::unique_ptr<impl::BorrowState[]> m_Borrows{};
+
+  template <typename T>
+  impl::BorrowState *borrowState() {
+    if constexpr (SOLARIS_CHECK_BORROWS)
+      return &m_Borrows[impl::resourceTypeID<std::remove_const_t<T>>()];
+    else
+      return nullptr;
+  }
+
+protected:
+  Resources() = default;
+  // slots point into the owning object, so copies start out empty
+  Resources(const Resources &) : m_Slots{}, m_Borrows{} {}
+  Resources &operator=(const Resources &) { return *this; }
+
+  /** Only called while the owner is being constructed. */
+  template <typename T>
+  void bind(T &resource) {
+    auto id{impl::resourceTypeID<T>()};
+    if (id >= m_Slots.size()) {
+      m_Slots.resize(id + 1, nullptr);
+      if constexpr (SOLARIS_CHECK_BORROWS)
+        m_Borrows = std::make_unique<impl::BorrowState[]>(m_Slots.size());
+    }
+    m_Slots[id] = &resource;
+  }
+
 public:
   virtual ~Resources() = default;
 
+  /** Returns the resource of type T, or nullptr if there is none. */
+  template <typename T>
+  T *tryGet() {
+    auto id{impl::resourceTypeID<T>()};
+    if (id >= m_Slots.size())
+      return nullptr;
+    return static_cast<T *>(m_Slots[id]);
+  }
+
+  /** Returns the resource of type T, or throws `std::bad_cast`. */
   template <typename T>
   T &get() {
-    return dynamic_cast<ResourceOwner<T> &>(*this).getResource();
+    if (auto resource{tryGet<T>()})
+      return *resource;
+    throw std::bad_cast();
+  }
+
+  /** Borrows the resource of type T for reading, see `Borrow`. */
+  template <typename T>
+  ReadBorrow<T> read() {
+    return {get<T>(), borrowState<T>()};
+  }
+
+  /** Borrows the resource of type T for writing, see `Borrow`. */
+  template <typename T>
+  WriteBorrow<T> write() {
+    return {get<T>(), borrowState<T>()};
+  }
+
+  template <ResourceAccess A>
+  typename A::Borrow borrow() {
+    if constexpr (A::Exclusive)
+      return write<typename A::Resource>();
+    else
+      return read<typename A::Resource>();
   }
 };
 
 template <typename... Ts>
 class ResourceOwners final : public Resources, public ResourceOwner<Ts>... {
+  template <typename T>
+  static constexpr bool Owns{(std::same_as<T, Ts> || ...)};
+
 public:
   explicit ResourceOwners(Ts &&...res)
-      : Resources(), ResourceOwner<Ts>{std::move(res)}... {}
+      : Resources(), ResourceOwner<Ts>{std::move(res)}... {
+    (bind(ResourceOwner<Ts>::getResource()), ...);
+  }
+
+  ResourceOwners(ResourceOwners &&other)
+      : Resources(), ResourceOwner<Ts>{std::move(other)}... {
+    (bind(ResourceOwner<Ts>::getResource()), ...);
+  }
+
+  /** Resolved statically when T is one of the owned types. */
+  template <typename T>
+  T *tryGet() {
+    if constexpr (Owns<T>) {
+      return &ResourceOwner<T>::getResource();
+    } else {
+      return nullptr;
+    }
+  }
+
+  /** Resolved statically when T is one of the owned types. */
+  template <typename T>
+  T &get() {
+    if constexpr (Owns<T>) {
+      return ResourceOwner<T>::getResource();
+    } else {
+      return Resources::get<T>();
+    }
+  }
 
   template <typename T, typename... Args>
   ResourceOwners<T, Ts...> withResource(Args &&...args) {
     return ResourceOwners<T, Ts...>{
-        std::move(T{std::forward<Args>(args)...}),
-        std::move(ResourceOwner<Ts>::get())...,
+        T{std::forward<Args>(args)...},
+        std::move(ResourceOwner<Ts>::getResource())...,
     };
   }
 };
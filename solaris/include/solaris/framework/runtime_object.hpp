@@ -5,6 +5,14 @@
 #include <stdexcept>
 
 namespace solaris {
+namespace impl {
+/** Shape of null object pointers, which must outlive every pointer. */
+inline const RuntimeStruct &emptyRuntimeStruct() {
+  static const RuntimeStruct empty{};
+  return empty;
+}
+} // namespace impl
+
 template <typename T>
 class BasicObjectPtr {
   uint8_t *m_RootPtr;
@@ -72,12 +80,9 @@ public:
   SelectiveObjectPtr()
       : BasicObjectPtr<SelectiveObjectPtr>(
             nullptr,
-            RuntimeStruct::withMembers<Ts...>()
+            impl::emptyRuntimeStruct()
         ),
-        FieldPtr<Ts>(
-            BasicObjectPtr<SelectiveObjectPtr>::rootPtr(),
-            BasicObjectPtr<SelectiveObjectPtr>::runtimeStruct()
-        )... {}
+        FieldPtr<Ts>(size_t{0})... {}
   SelectiveObjectPtr(uint8_t *rootPtr, const RuntimeStruct &runtimeStruct)
       : BasicObjectPtr<SelectiveObjectPtr>(rootPtr, runtimeStruct),
         FieldPtr<Ts>(runtimeStruct)... {}
@@ -128,6 +133,9 @@ public:
 
   SelectiveObjectRef *operator->() { return this; }
 
+  /** Start of the referenced object, e.g. to reach fields outside of Ts. */
+  [[nodiscard]] uint8_t *data() const { return m_Ptr; }
+
   template <typename T, typename... Args>
   void emplaceField(Args &&...args) {
     // T *fieldPtr{SelectiveObjectPtr<Ts...>::template getFieldPtr<T>()};
@@ -153,7 +161,8 @@ SelectiveObjectRef<Ts...> SelectiveObjectPtr<Ts...>::operator->() const {
 
 class RawObjectPtr : public BasicObjectPtr<RawObjectPtr> {
 public:
-  RawObjectPtr(nullptr_t) : RawObjectPtr(nullptr, RuntimeStruct()) {}
+  RawObjectPtr(nullptr_t)
+      : RawObjectPtr(nullptr, impl::emptyRuntimeStruct()) {}
 
   RawObjectPtr(uint8_t *rootPtr, const RuntimeStruct &runtimeStruct)
       : BasicObjectPtr(rootPtr, runtimeStruct) {}
@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <set>
+#include <type_traits>
 #include <typeindex>
 #include <typeinfo>
 #include <utility>
@@ -20,6 +21,8 @@ struct RuntimeField {
   CopyFunctionPtr CopyFunction;
   DestructorFunctionPtr DestructorFunction;
   MoveFunctionPtr MoveFunction;
+  /** Whether `CopyFunction` may be replaced by copying `Size` bytes. */
+  bool TriviallyCopyable{false};
 
   template <typename T>
   static RuntimeField runtimeFieldFor() {
@@ -30,6 +33,7 @@ struct RuntimeField {
         .CopyFunction = &RuntimeField::basicCopyFunction<T>,
         .DestructorFunction = &RuntimeField::basicDestructorFunction<T>,
         .MoveFunction = &RuntimeField::basicMoveFunction<T>,
+        .TriviallyCopyable = std::is_trivially_copyable_v<T>,
     };
   }
 
@@ -75,7 +79,7 @@ struct RuntimeStruct {
 
   explicit RuntimeStruct(const std::set<RuntimeField> &fields) : Members() {
     size_t offset{0};
-    size_t maxAlignment{0};
+    size_t maxAlignment{1};
 
     Members.reserve(fields.size());
 
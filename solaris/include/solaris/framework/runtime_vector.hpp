@@ -3,6 +3,7 @@
 #include <solaris/framework/allocation.hpp>
 #include <solaris/framework/runtime_object.hpp>
 #include <solaris/framework/runtime_struct.hpp>
+#include <utility>
 
 namespace solaris {
 class RuntimeVector {
@@ -10,6 +11,8 @@ class RuntimeVector {
   Allocation m_Allocation;
   size_t m_Capacity;
   size_t m_Size;
+  // one object's worth of space for swap, allocated on first use
+  Allocation m_Scratch{0};
 
 public:
   template <typename... Ts>
@@ -42,6 +45,27 @@ public:
       : m_RuntimeStruct{std::move(runtimeStruct)}, m_Allocation{0},
         m_Capacity{0}, m_Size{0} {}
 
+  RuntimeVector(RuntimeVector &&other) noexcept
+      : m_RuntimeStruct{std::move(other.m_RuntimeStruct)},
+        m_Allocation{std::move(other.m_Allocation)},
+        m_Capacity{std::exchange(other.m_Capacity, 0)},
+        m_Size{std::exchange(other.m_Size, 0)},
+        m_Scratch{std::move(other.m_Scratch)} {}
+
+  RuntimeVector &operator=(RuntimeVector &&other) noexcept {
+    if (this == &other)
+      return *this;
+    clear();
+    m_RuntimeStruct = std::move(other.m_RuntimeStruct);
+    m_Allocation = std::move(other.m_Allocation);
+    m_Capacity = std::exchange(other.m_Capacity, 0);
+    m_Size = std::exchange(other.m_Size, 0);
+    m_Scratch = std::move(other.m_Scratch);
+    return *this;
+  }
+
+  ~RuntimeVector() { clear(); }
+
 private:
   void ensureCapacity(size_t requested) {
     if (m_Capacity >= requested)
@@ -54,6 +78,10 @@ private:
     while (newCapacity < requested)
       newCapacity *= 2;
 
+    reallocate(newCapacity);
+  }
+
+  void reallocate(size_t newCapacity) {
     Allocation newAllocation{newCapacity * m_RuntimeStruct.Stride};
 
     for (size_t i{0}; i < m_Size; ++i) {
@@ -61,13 +89,7 @@ private:
 
       auto source{offset + (uint8_t *)m_Allocation};
       auto destination{offset + (uint8_t *)newAllocation};
-
-      for (const auto &member : m_RuntimeStruct.Members) {
-        member.Field.MoveFunction(
-            reinterpret_cast<void *>(source + member.Offset),
-            reinterpret_cast<void *>(destination + member.Offset)
-        );
-      }
+      moveObject(source, destination);
     }
 
     m_Allocation = std::move(newAllocation);
@@ -78,6 +100,15 @@ private:
     return index * m_RuntimeStruct.Stride + (uint8_t *)m_Allocation;
   }
 
+  void moveObject(uint8_t *source, uint8_t *destination) const {
+    for (const auto &member : m_RuntimeStruct.Members) {
+      member.Field.MoveFunction(
+          reinterpret_cast<void *>(source + member.Offset),
+          reinterpret_cast<void *>(destination + member.Offset)
+      );
+    }
+  }
+
 public:
   RawObjectPtr pushBack() {
     ensureCapacity(m_Size + 1);
@@ -88,15 +119,78 @@ public:
     return {ptr, m_RuntimeStruct};
   }
 
+  /**
+   * Appends `count` objects, left for the caller to construct, growing the
+   * storage at most once. Returns the first of them.
+   */
+  RawObjectPtr pushBack(size_t count) {
+    ensureCapacity(m_Size + count);
+
+    auto ptr{uncheckedGet(m_Size)};
+    m_Size += count;
+
+    return {ptr, m_RuntimeStruct};
+  }
+
   RawObjectPtr operator[](size_t index) const {
     auto ptr{uncheckedGet(index)};
     return {ptr, m_RuntimeStruct};
   }
 
+  /**
+   * Removes the object at `index`, whose fields must already have been moved
+   * out or destroyed, by moving the last object into its place.
+   */
+  void eraseMoved(size_t index) {
+    auto last{m_Size - 1};
+    if (index != last)
+      moveObject(uncheckedGet(last), uncheckedGet(index));
+    m_Size = last;
+  }
+
+  /** Removes the object at `index`, moving the last object into its place. */
+  void erase(size_t index) {
+    auto object{uncheckedGet(index)};
+    for (const auto &member : m_RuntimeStruct.Members)
+      member.Field.DestructorFunction(object + member.Offset);
+    eraseMoved(index);
+  }
+
+  /** Destroys every object, keeping the capacity. */
+  void clear() {
+    for (size_t i{0}; i < m_Size; ++i) {
+      auto object{uncheckedGet(i)};
+      for (const auto &member : m_RuntimeStruct.Members)
+        member.Field.DestructorFunction(object + member.Offset);
+    }
+    m_Size = 0;
+  }
+
+  void swap(size_t a, size_t b) {
+    if (a == b)
+      return;
+    // a separate temporary, so swapping never grows the storage
+    if (!m_Scratch.get())
+      m_Scratch = Allocation{m_RuntimeStruct.Stride};
+    auto temporary{(uint8_t *)m_Scratch};
+    moveObject(uncheckedGet(a), temporary);
+    moveObject(uncheckedGet(b), uncheckedGet(a));
+    moveObject(temporary, uncheckedGet(b));
+  }
+
+  /** Start of the objects, each `runtimeStruct().Stride` bytes apart. */
+  [[nodiscard]] uint8_t *data() const { return uncheckedGet(0); }
+
   size_t size() const { return m_Size; }
 
   size_t capacity() const { return m_Capacity; }
 
+  /** Releases the capacity beyond the current objects. */
+  void shrinkToFit() {
+    if (m_Capacity != m_Size)
+      reallocate(m_Size);
+  }
+
   [[nodiscard]] const RuntimeStruct &runtimeStruct() const {
     return m_RuntimeStruct;
   }
@@ -0,0 +1,666 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <solaris/framework/ecs.hpp>
+#include <solaris/math/matrix.hpp>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace solaris {
+struct Ray {
+  Vec3f Origin;
+  Vec3f Direction;
+};
+
+/** Axis-aligned box, inclusive of its faces. */
+struct Bounds {
+  Vec3f Min;
+  Vec3f Max;
+
+  static Bounds around(const Vec3f &center, float radius) {
+    Vec3f extent{radius, radius, radius};
+    return {center - extent, center + extent};
+  }
+
+  [[nodiscard]] bool contains(const Vec3f &point) const {
+    for (size_t axis{0}; axis < 3; ++axis) {
+      if (point[axis] < Min[axis] || point[axis] > Max[axis])
+        return false;
+    }
+    return true;
+  }
+
+  [[nodiscard]] bool intersects(const Bounds &other) const {
+    for (size_t axis{0}; axis < 3; ++axis) {
+      if (other.Max[axis] < Min[axis] || other.Min[axis] > Max[axis])
+        return false;
+    }
+    return true;
+  }
+
+  /**
+   * The distances along the unit `ray.Direction` between which the segment
+   * from `ray.Origin` to `maxDistance` is inside the box, found by clipping
+   * it against each slab, or nothing if it misses the box.
+   */
+  [[nodiscard]] std::optional<std::pair<float, float>>
+  clip(const Ray &ray, float maxDistance) const {
+    float near{0};
+    float far{maxDistance};
+    for (size_t axis{0}; axis < 3; ++axis) {
+      auto origin{ray.Origin[axis]};
+      auto direction{ray.Direction[axis]};
+      if (direction == 0) {
+        if (origin < Min[axis] || origin > Max[axis])
+          return std::nullopt;
+        continue;
+      }
+      auto t0{(Min[axis] - origin) / direction};
+      auto t1{(Max[axis] - origin) / direction};
+      near = std::max(near, std::min(t0, t1));
+      far = std::min(far, std::max(t0, t1));
+      if (near > far)
+        return std::nullopt;
+    }
+    return std::pair{near, far};
+  }
+
+  /** Whether the segment of `clip` crosses the box. */
+  [[nodiscard]] bool intersects(const Ray &ray, float maxDistance) const {
+    return clip(ray, maxDistance).has_value();
+  }
+
+  [[nodiscard]] Bounds merge(const Bounds &other) const {
+    Bounds output;
+    for (size_t axis{0}; axis < 3; ++axis) {
+      output.Min[axis] = std::min(Min[axis], other.Min[axis]);
+      output.Max[axis] = std::max(Max[axis], other.Max[axis]);
+    }
+    return output;
+  }
+};
+
+/** Called with the entity and position of every candidate of a query. */
+using SpatialVisitor = std::function<void(Entity, const Vec3f &)>;
+
+/**
+ * Acceleration structure behind a `SpatialIndex`. Queries may report
+ * candidates outside of the queried region, but never miss a point inside
+ * of it; they see changes once `refresh()` was called.
+ */
+template <typename S>
+concept SpatialStructure = requires(
+    S &structure,
+    const S &view,
+    Entity entity,
+    const Vec3f &position,
+    const Bounds &bounds,
+    const Ray &ray,
+    const SpatialVisitor &visit
+) {
+  structure.insert(entity, position);
+  structure.remove(entity, position);
+  structure.move(entity, position, position);
+  structure.refresh();
+  view.query(bounds, visit);
+  view.raycast(ray, 1.0f, 1.0f, visit);
+};
+
+/**
+ * Hashed grid of cubic cells, so it needs no world bounds. Every change
+ * only touches the cells involved, which suits entities that move every
+ * frame; cells should be about the size of a typical query.
+ */
+class UniformGrid {
+  struct Point {
+    Entity Id;
+    Vec3f Position;
+  };
+
+  struct CellHash {
+    size_t operator()(const Vec3i &cell) const noexcept {
+      auto hash{static_cast<size_t>(static_cast<uint32_t>(cell.x()))};
+      hash = hash * 0x9E3779B1u + static_cast<uint32_t>(cell.y());
+      hash = hash * 0x9E3779B1u + static_cast<uint32_t>(cell.z());
+      return hash;
+    }
+  };
+
+  float m_CellSize;
+  std::unordered_map<Vec3i, std::vector<Point>, CellHash> m_Cells{};
+  /** Contains every point; only reset once the grid is empty. */
+  std::optional<Bounds> m_Occupied{};
+
+  void occupy(const Vec3f &position) {
+    Bounds point{position, position};
+    m_Occupied = m_Occupied ? m_Occupied->merge(point) : point;
+  }
+
+  [[nodiscard]] Vec3i cellOf(const Vec3f &position) const {
+    // clamped so that unbounded queries stay representable
+    constexpr float limit{1 << 30};
+    Vec3i cell;
+    for (size_t axis{0}; axis < 3; ++axis) {
+      auto coordinate{std::floor(position[axis] / m_CellSize)};
+      cell[axis] = static_cast<int>(std::clamp(coordinate, -limit, limit));
+    }
+    return cell;
+  }
+
+  template <typename F>
+  void forEachCell(const Bounds &bounds, F &&visitCell) const {
+    auto first{cellOf(bounds.Min)};
+    auto last{cellOf(bounds.Max)};
+
+    // large regions are cheaper to test against the occupied cells
+    double span{1};
+    for (size_t axis{0}; axis < 3; ++axis)
+      span *= double(last[axis]) - double(first[axis]) + 1;
+    if (span > double(m_Cells.size())) {
+      for (const auto &[cell, points] : m_Cells) {
+        if (cell.x() >= first.x() && cell.x() <= last.x() &&
+            cell.y() >= first.y() && cell.y() <= last.y() &&
+            cell.z() >= first.z() && cell.z() <= last.z())
+          visitCell(cell, points);
+      }
+      return;
+    }
+
+    for (auto x{first.x()}; x <= last.x(); ++x) {
+      for (auto y{first.y()}; y <= last.y(); ++y) {
+        for (auto z{first.z()}; z <= last.z(); ++z) {
+          Vec3i cell{x, y, z};
+          auto it{m_Cells.find(cell)};
+          if (it != m_Cells.end())
+            visitCell(cell, it->second);
+        }
+      }
+    }
+  }
+
+public:
+  explicit UniformGrid(float cellSize = 1.0f) : m_CellSize{cellSize} {}
+
+  void insert(Entity entity, const Vec3f &position) {
+    m_Cells[cellOf(position)].push_back({entity, position});
+    occupy(position);
+  }
+
+  void remove(Entity entity, const Vec3f &position) {
+    auto it{m_Cells.find(cellOf(position))};
+    if (it == m_Cells.end())
+      return;
+
+    auto &points{it->second};
+    auto point{std::ranges::find(points, entity, &Point::Id)};
+    if (point == points.end())
+      return;
+    *point = points.back();
+    points.pop_back();
+    if (points.empty())
+      m_Cells.erase(it);
+    if (m_Cells.empty())
+      m_Occupied.reset();
+  }
+
+  void move(Entity entity, const Vec3f &from, const Vec3f &to) {
+    auto cell{cellOf(to)};
+    if (cell != cellOf(from)) {
+      remove(entity, from);
+      m_Cells[cell].push_back({entity, to});
+      occupy(to);
+      return;
+    }
+
+    occupy(to);
+
+    auto &points{m_Cells[cell]};
+    auto point{std::ranges::find(points, entity, &Point::Id)};
+    if (point != points.end())
+      point->Position = to;
+  }
+
+  void refresh() {}
+
+  void query(const Bounds &bounds, const SpatialVisitor &visit) const {
+    forEachCell(bounds, [&](const Vec3i &, const std::vector<Point> &points) {
+      for (const auto &point : points)
+        visit(point.Id, point.Position);
+    });
+  }
+
+  /**
+   * Walks the cells along the part of the ray inside the occupied region,
+   * one cell-sized step at a time, or tests every occupied cell instead
+   * when that is fewer cells than steps.
+   */
+  void raycast(
+      const Ray &ray,
+      float maxDistance,
+      float radius,
+      const SpatialVisitor &visit
+  ) const {
+    if (!m_Occupied)
+      return;
+    // padded by a cell, so rounding cannot clip off points on the faces
+    auto padding{radius + m_CellSize};
+    Vec3f margin{padding, padding, padding};
+    Bounds region{m_Occupied->Min - margin, m_Occupied->Max + margin};
+    auto range{region.clip(ray, maxDistance)};
+    if (!range)
+      return;
+    auto [near, far]{*range};
+    // without a direction, the ray only covers its origin
+    if (!std::isfinite(far))
+      far = near;
+
+    auto steps{std::ceil(double(far - near) / m_CellSize)};
+    if (steps > double(m_Cells.size())) {
+      Ray clipped{ray.Origin + ray.Direction * near, ray.Direction};
+      for (const auto &[cell, points] : m_Cells) {
+        Vec3f center{
+            (float(cell.x()) + 0.5f) * m_CellSize,
+            (float(cell.y()) + 0.5f) * m_CellSize,
+            (float(cell.z()) + 0.5f) * m_CellSize,
+        };
+        // half a cell more than the cell, for the same rounding
+        auto box{Bounds::around(center, m_CellSize + radius)};
+        if (!box.intersects(clipped, far - near))
+          continue;
+        for (const auto &point : points)
+          visit(point.Id, point.Position);
+      }
+      return;
+    }
+
+    std::unordered_set<Vec3i, CellHash> visited;
+    auto count{std::max(size_t{1}, static_cast<size_t>(steps))};
+    for (size_t i{0}; i < count; ++i) {
+      auto start{near + static_cast<float>(i) * m_CellSize};
+      auto end{i + 1 == count ? far : std::min(start + m_CellSize, far)};
+      Vec3f from{ray.Origin + ray.Direction * start};
+      Vec3f to{ray.Origin + ray.Direction * end};
+      auto step{Bounds::around(from, radius).merge(Bounds::around(to, radius))};
+
+      forEachCell(step, [&](const Vec3i &cell, const auto &points) {
+        if (!visited.insert(cell).second)
+          return;
+        for (const auto &point : points)
+          visit(point.Id, point.Position);
+      });
+    }
+  }
+};
+
+/**
+ * Bounding volume hierarchy over the points. Moves only refit the boxes of
+ * the existing tree, while insertions and removals rebuild it on the next
+ * `refresh()`, so it suits entities that are mostly static.
+ */
+class Bvh {
+  static constexpr size_t LeafSize{8};
+
+  struct Point {
+    Entity Id;
+    Vec3f Position;
+  };
+
+  /** Leaves have a Count; the left child of a node directly follows it. */
+  struct Node {
+    Bounds Box;
+    uint32_t Begin;
+    uint32_t Count;
+    uint32_t Right;
+  };
+
+  std::vector<Point> m_Points{};
+  std::unordered_map<Entity, size_t> m_Slots{};
+  std::vector<Node> m_Nodes{};
+  bool m_Rebuild{false};
+  bool m_Refit{false};
+
+  [[nodiscard]] Bounds boundsOf(size_t begin, size_t end) const {
+    Bounds box{m_Points[begin].Position, m_Points[begin].Position};
+    for (size_t i{begin + 1}; i < end; ++i) {
+      for (size_t axis{0}; axis < 3; ++axis) {
+        box.Min[axis] = std::min(box.Min[axis], m_Points[i].Position[axis]);
+        box.Max[axis] = std::max(box.Max[axis], m_Points[i].Position[axis]);
+      }
+    }
+    return box;
+  }
+
+  void build(size_t begin, size_t end) {
+    auto index{m_Nodes.size()};
+    m_Nodes.push_back(
+        {.Box = boundsOf(begin, end), .Begin = 0, .Count = 0, .Right = 0}
+    );
+    auto count{end - begin};
+    if (count <= LeafSize) {
+      m_Nodes[index].Begin = static_cast<uint32_t>(begin);
+      m_Nodes[index].Count = static_cast<uint32_t>(count);
+      return;
+    }
+
+    // split at the median of the longest axis
+    auto extent{m_Nodes[index].Box.Max - m_Nodes[index].Box.Min};
+    size_t axis{0};
+    if (extent[1] > extent[axis])
+      axis = 1;
+    if (extent[2] > extent[axis])
+      axis = 2;
+    auto middle{begin + count / 2};
+    std::nth_element(
+        m_Points.begin() + begin,
+        m_Points.begin() + middle,
+        m_Points.begin() + end,
+        [axis](const Point &a, const Point &b) {
+          return a.Position[axis] < b.Position[axis];
+        }
+    );
+
+    build(begin, middle);
+    m_Nodes[index].Right = static_cast<uint32_t>(m_Nodes.size());
+    build(middle, end);
+  }
+
+  template <typename Overlaps>
+  void traverse(Overlaps &&overlaps, const SpatialVisitor &visit) const {
+    if (m_Nodes.empty())
+      return;
+
+    std::vector<uint32_t> stack{0};
+    while (!stack.empty()) {
+      auto index{stack.back()};
+      stack.pop_back();
+      const auto &node{m_Nodes[index]};
+      if (!overlaps(node.Box))
+        continue;
+      if (node.Count > 0) {
+        for (size_t i{node.Begin}; i < node.Begin + node.Count; ++i)
+          visit(m_Points[i].Id, m_Points[i].Position);
+        continue;
+      }
+      stack.push_back(node.Right);
+      stack.push_back(index + 1);
+    }
+  }
+
+public:
+  void insert(Entity entity, const Vec3f &position) {
+    m_Slots[entity] = m_Points.size();
+    m_Points.push_back({entity, position});
+    m_Rebuild = true;
+  }
+
+  void remove(Entity entity, const Vec3f &) {
+    auto it{m_Slots.find(entity)};
+    if (it == m_Slots.end())
+      return;
+
+    auto slot{it->second};
+    m_Slots.erase(it);
+    if (slot != m_Points.size() - 1) {
+      m_Points[slot] = m_Points.back();
+      m_Slots[m_Points[slot].Id] = slot;
+    }
+    m_Points.pop_back();
+    m_Rebuild = true;
+  }
+
+  void move(Entity entity, const Vec3f &, const Vec3f &to) {
+    auto it{m_Slots.find(entity)};
+    if (it == m_Slots.end())
+      return;
+    m_Points[it->second].Position = to;
+    m_Refit = true;
+  }
+
+  void refresh() {
+    if (m_Rebuild) {
+      m_Nodes.clear();
+      if (!m_Points.empty())
+        build(0, m_Points.size());
+      for (size_t i{0}; i < m_Points.size(); ++i)
+        m_Slots[m_Points[i].Id] = i;
+    } else if (m_Refit) {
+      // children follow their parents, so a reverse pass goes bottom-up
+      for (auto index{m_Nodes.size()}; index-- > 0;) {
+        auto &node{m_Nodes[index]};
+        if (node.Count > 0)
+          node.Box = boundsOf(node.Begin, node.Begin + node.Count);
+        else
+          node.Box = m_Nodes[index + 1].Box.merge(m_Nodes[node.Right].Box);
+      }
+    }
+    m_Rebuild = false;
+    m_Refit = false;
+  }
+
+  void query(const Bounds &bounds, const SpatialVisitor &visit) const {
+    traverse([&](const Bounds &box) { return box.intersects(bounds); }, visit);
+  }
+
+  void raycast(
+      const Ray &ray,
+      float maxDistance,
+      float radius,
+      const SpatialVisitor &visit
+  ) const {
+    Vec3f margin{radius, radius, radius};
+    traverse(
+        [&](const Bounds &box) {
+          return Bounds{box.Min - margin, box.Max + margin}.intersects(
+              ray, maxDistance
+          );
+        },
+        visit
+    );
+  }
+};
+
+/**
+ * Tracks the position of every entity with a P component, e.g. a Vec3f, and
+ * answers proximity queries with entity ids instead of scanning the world.
+ * `Projection` maps a P to its Vec3f position.
+ */
+template <
+    typename P,
+    SpatialStructure S = UniformGrid,
+    typename Projection = std::identity>
+  requires std::convertible_to<
+      std::invoke_result_t<Projection &, const P &>,
+      Vec3f>
+class SpatialIndex {
+  struct Tracked {
+    Vec3f Position;
+    size_t Generation;
+  };
+
+  S m_Structure;
+  Projection m_Projection;
+  std::unordered_map<Entity, Tracked> m_Tracked{};
+  size_t m_Generation{0};
+
+  void track(Entity entity, const Vec3f &position) {
+    auto [it, inserted]{m_Tracked.try_emplace(entity, position, m_Generation)};
+    if (inserted) {
+      m_Structure.insert(entity, position);
+      return;
+    }
+
+    auto &tracked{it->second};
+    tracked.Generation = m_Generation;
+    if (tracked.Position == position)
+      return;
+    m_Structure.move(entity, tracked.Position, position);
+    tracked.Position = position;
+  }
+
+public:
+  explicit SpatialIndex(S structure = S{}, Projection projection = {})
+      : m_Structure{std::move(structure)},
+        m_Projection{std::move(projection)} {}
+
+  [[nodiscard]] size_t size() const { return m_Tracked.size(); }
+
+  /**
+   * Catches up with the positions in `world` by rescanning every entity
+   * with a P and comparing it with its last known position; only those
+   * that appeared, moved or disappeared touch the structure. When the
+   * changed entities are known, the overload taking them skips the scan.
+   */
+  void update(const World &world) {
+    ++m_Generation;
+    for (auto [entity, components] :
+         world.query(World::View::withComponents<P>())) {
+      const auto &component{components.template getField<P>()};
+      track(entity, std::invoke(m_Projection, component));
+    }
+
+    std::erase_if(m_Tracked, [this](const auto &entry) {
+      const auto &[entity, tracked]{entry};
+      if (tracked.Generation == m_Generation)
+        return false;
+      m_Structure.remove(entity, tracked.Position);
+      return true;
+    });
+    m_Structure.refresh();
+  }
+
+  /**
+   * Catches up with the positions of `changed` alone, e.g. the entities of
+   * ComponentSet<P> events or those a system moved. Entities among them
+   * that lost their P or were destroyed are forgotten.
+   */
+  void update(const World &world, std::span<const Entity> changed) {
+    for (auto entity : changed) {
+      if (const auto *component{world.get<P>(entity)}) {
+        track(entity, std::invoke(m_Projection, *component));
+        continue;
+      }
+      if (auto it{m_Tracked.find(entity)}; it != m_Tracked.end()) {
+        m_Structure.remove(entity, it->second.Position);
+        m_Tracked.erase(it);
+      }
+    }
+    m_Structure.refresh();
+  }
+
+  /** Records a single change, e.g. from a system that just moved `entity`. */
+  void set(Entity entity, const Vec3f &position) {
+    track(entity, position);
+    m_Structure.refresh();
+  }
+
+  void remove(Entity entity) {
+    auto it{m_Tracked.find(entity)};
+    if (it == m_Tracked.end())
+      return;
+    m_Structure.remove(entity, it->second.Position);
+    m_Tracked.erase(it);
+    m_Structure.refresh();
+  }
+
+  /** Entities inside `bounds`. */
+  [[nodiscard]] std::vector<Entity> box(const Bounds &bounds) const {
+    std::vector<Entity> output;
+    m_Structure.query(bounds, [&](Entity entity, const Vec3f &position) {
+      if (bounds.contains(position))
+        output.push_back(entity);
+    });
+    return output;
+  }
+
+  /** Entities within `radius` of `center`. */
+  [[nodiscard]] std::vector<Entity>
+  sphere(const Vec3f &center, float radius) const {
+    std::vector<Entity> output;
+    m_Structure.query(
+        Bounds::around(center, radius),
+        [&](Entity entity, const Vec3f &position) {
+          Vec3f offset{position - center};
+          if (offset.dot(offset) <= radius * radius)
+            output.push_back(entity);
+        }
+    );
+    return output;
+  }
+
+  /**
+   * Entities within `radius` of the segment from `ray.Origin` to
+   * `maxDistance` along `ray.Direction`, ordered along the ray.
+   */
+  [[nodiscard]] std::vector<Entity>
+  raycast(const Ray &ray, float maxDistance, float radius = 0) const {
+    Ray unit{ray.Origin, ray.Direction.normalized()};
+    std::vector<std::pair<float, Entity>> hits;
+    m_Structure.raycast(
+        unit,
+        maxDistance,
+        radius,
+        [&](Entity entity, const Vec3f &position) {
+          Vec3f offset{position - unit.Origin};
+          auto along{offset.dot(unit.Direction)};
+          along = std::clamp(along, 0.0f, maxDistance);
+          Vec3f closest{unit.Direction * along - offset};
+          if (closest.dot(closest) <= radius * radius)
+            hits.emplace_back(along, entity);
+        }
+    );
+
+    std::ranges::sort(hits);
+    std::vector<Entity> output;
+    output.reserve(hits.size());
+    for (const auto &[along, entity] : hits)
+      output.push_back(entity);
+    return output;
+  }
+
+  /**
+   * The `count` entities closest to `point`, closest first. Searches boxes
+   * of doubling size until they hold enough entities.
+   */
+  [[nodiscard]] std::vector<Entity>
+  nearest(const Vec3f &point, size_t count) const {
+    count = std::min(count, m_Tracked.size());
+    std::vector<std::pair<float, Entity>> candidates;
+    for (float radius{1}; count > 0; radius *= 2) {
+      auto all{!std::isfinite(radius)};
+      candidates.clear();
+      m_Structure.query(
+          all ? Bounds::around(point, std::numeric_limits<float>::max())
+              : Bounds::around(point, radius),
+          [&](Entity entity, const Vec3f &position) {
+            Vec3f offset{position - point};
+            auto distance{offset.dot(offset)};
+            // a box also holds points farther than its half-size
+            if (all || distance <= radius * radius)
+              candidates.emplace_back(distance, entity);
+          }
+      );
+      if (candidates.size() >= count || all)
+        break;
+    }
+
+    count = std::min(count, candidates.size());
+    std::ranges::partial_sort(candidates, candidates.begin() + count);
+    std::vector<Entity> output;
+    output.reserve(count);
+    for (size_t i{0}; i < count; ++i)
+      output.push_back(candidates[i].second);
+    return output;
+  }
+};
+} // namespace solaris
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <solaris/core/thread_pool.hpp>
+#include <solaris/framework/resources.hpp>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace solaris::framework {
+/**
+ * Runs systems that declare up front which resources they read and write.
+ *
+ * Systems are grouped into stages as they are added: a system goes into the
+ * first stage after every earlier system it conflicts with, so conflicting
+ * systems keep their registration order and each stage can run in parallel.
+ */
+class SystemScheduler {
+  struct System {
+    AccessSet Access;
+    std::function<void(Resources &)> Run;
+    size_t Stage;
+  };
+
+  std::vector<System> m_Systems{};
+  std::vector<std::vector<size_t>> m_Stages{};
+
+public:
+  /**
+   * Adds a system that is called with a reference per declared access, e.g.
+   * `addSystem<Read<Input>, Write<Physics>>([](const Input&, Physics&) {})`.
+   */
+  template <ResourceAccess... As, typename F>
+    requires std::invocable<
+        F &,
+        decltype(*std::declval<typename As::Borrow &>())...>
+  void addSystem(F &&system) {
+    auto access{AccessSet::of<As...>()};
+
+    size_t stage{0};
+    for (const auto &other : m_Systems) {
+      if (other.Access.conflictsWith(access))
+        stage = std::max(stage, other.Stage + 1);
+    }
+    if (stage == m_Stages.size())
+      m_Stages.emplace_back();
+    m_Stages[stage].push_back(m_Systems.size());
+
+    m_Systems.push_back({
+        .Access = std::move(access),
+        .Run =
+            [system = std::forward<F>(system)](Resources &resources) mutable {
+              std::tuple<typename As::Borrow...> borrows{
+                  resources.borrow<As>()...
+              };
+              std::apply(
+                  [&system](auto &...borrow) { system(*borrow...); }, borrows
+              );
+            },
+        .Stage = stage,
+    });
+  }
+
+  /** Indices of the systems in each stage, by order of addition. */
+  [[nodiscard]] const std::vector<std::vector<size_t>> &stages() const {
+    return m_Stages;
+  }
+
+  /** Runs every system on the calling thread, in the order they were added. */
+  void run(Resources &resources) {
+    for (auto &system : m_Systems)
+      system.Run(resources);
+  }
+
+  /** Runs the systems stage by stage, each stage in parallel on `pool`. */
+  void run(Resources &resources, core::ThreadPool &pool) {
+    for (const auto &stage : m_Stages) {
+      pool.parallelFor(stage.size(), [&](size_t index) {
+        m_Systems[stage[index]].Run(resources);
+      });
+    }
+  }
+};
+} // namespace solaris::framework
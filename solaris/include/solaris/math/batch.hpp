@@ -0,0 +1,169 @@
+#pragma once
+
+#include "matrix.hpp"
+#include "quaternion.hpp"
+#include "simd.hpp"
+#include <cstddef>
+#include <span>
+
+/**
+ * Transforms over contiguous arrays of matrices and vectors, e.g. ECS
+ * columns. Outputs must be at least as long as the inputs and may alias
+ * them exactly, so every function can also run in place. Inputs paired
+ * element by element must be as long as each other; lengths are not checked.
+ */
+namespace solaris::batch {
+static_assert(sizeof(Vec4f) == 4 * sizeof(float));
+static_assert(sizeof(Matrix4f) == 16 * sizeof(float));
+static_assert(sizeof(Quatf) == 4 * sizeof(float));
+
+namespace impl {
+template <typename T>
+const float *floats(std::span<const T> values) {
+  return reinterpret_cast<const float *>(values.data());
+}
+
+template <typename T>
+float *floats(std::span<T> values) {
+  return reinterpret_cast<float *>(values.data());
+}
+} // namespace impl
+
+/** Separate x, y and z arrays of equal length. */
+template <typename T>
+struct Vec3Columns {
+  std::span<T> X;
+  std::span<T> Y;
+  std::span<T> Z;
+
+  [[nodiscard]] size_t size() const { return X.size(); }
+};
+
+/** output[i] = matrix * input[i] */
+inline void transform(
+    const Matrix4f &matrix,
+    std::span<const Vec4f> input,
+    std::span<Vec4f> output
+) {
+  simd::transform4Batch(
+      matrix.data(), impl::floats(input), impl::floats(output), input.size()
+  );
+}
+
+inline void transform(const Matrix4f &matrix, std::span<Vec4f> vectors) {
+  transform(matrix, std::span<const Vec4f>{vectors}, vectors);
+}
+
+/** output[i] = matrices[i] * input[i], vectorized across elements. */
+inline void transform(
+    std::span<const Matrix4f> matrices,
+    std::span<const Vec4f> input,
+    std::span<Vec4f> output
+) {
+  simd::transform4Each(
+      impl::floats(matrices),
+      impl::floats(input),
+      impl::floats(output),
+      input.size()
+  );
+}
+
+/**
+ * output[i] = parents[i] * locals[i], the world transforms of a level of a
+ * hierarchy given its parents' world transforms and its local transforms.
+ * Vectorized across elements.
+ */
+inline void multiply(
+    std::span<const Matrix4f> parents,
+    std::span<const Matrix4f> locals,
+    std::span<Matrix4f> output
+) {
+  simd::multiply4x4Each(
+      impl::floats(parents),
+      impl::floats(locals),
+      impl::floats(output),
+      locals.size()
+  );
+}
+
+/** Transforms points (w = 1) stored as separate x, y and z arrays. */
+inline void transformPoints(
+    const Matrix4f &matrix,
+    const Vec3Columns<const float> &input,
+    const Vec3Columns<float> &output
+) {
+  simd::transformSoa(
+      matrix.data(),
+      1.0f,
+      input.X.data(),
+      input.Y.data(),
+      input.Z.data(),
+      output.X.data(),
+      output.Y.data(),
+      output.Z.data(),
+      input.size()
+  );
+}
+
+/** Transforms directions (w = 0), ignoring the matrix's translation. */
+inline void transformDirections(
+    const Matrix4f &matrix,
+    const Vec3Columns<const float> &input,
+    const Vec3Columns<float> &output
+) {
+  simd::transformSoa(
+      matrix.data(),
+      0.0f,
+      input.X.data(),
+      input.Y.data(),
+      input.Z.data(),
+      output.X.data(),
+      output.Y.data(),
+      output.Z.data(),
+      input.size()
+  );
+}
+
+inline void
+transformPoints(const Matrix4f &matrix, const Vec3Columns<float> &points) {
+  transformPoints(matrix, {points.X, points.Y, points.Z}, points);
+}
+
+/**
+ * output[i] = slerp(from[i], to[i], t[i]) for unit quaternions, e.g. when
+ * blending two animation poses bone by bone. Uses a polynomial estimate of
+ * slerp that is vectorized across quaternions.
+ */
+inline void slerp(
+    std::span<const Quatf> from,
+    std::span<const Quatf> to,
+    std::span<const float> t,
+    std::span<Quatf> output
+) {
+  simd::slerpBatch(
+      impl::floats(from),
+      impl::floats(to),
+      t.data(),
+      1,
+      impl::floats(output),
+      from.size()
+  );
+}
+
+/** Blends every pair of quaternions with the same t. */
+inline void slerp(
+    std::span<const Quatf> from,
+    std::span<const Quatf> to,
+    float t,
+    std::span<Quatf> output
+) {
+  simd::slerpBatch(
+      impl::floats(from),
+      impl::floats(to),
+      &t,
+      0,
+      impl::floats(output),
+      from.size()
+  );
+}
+} // namespace solaris::batch
@@ -1,9 +1,14 @@
 #pragma once
 
+#include "simd.hpp"
 #include <array>
+#include <cmath>
 #include <concepts>
 #include <cstddef>
-#include <cstring>
+#include <functional>
+#include <ostream>
+#include <type_traits>
+#include <utility>
 
 namespace solaris {
 
@@ -23,8 +28,245 @@ template <Subtractible T>
 T subtract(const T &a, const T &b) {
   return a - b;
 }
+
+/**
+ * Closed-form 4x4 inverse via the 2x2 sub-determinants of the top and
+ * bottom row pairs. Works on either storage order, since inverting the
+ * transpose gives the transposed inverse.
+ */
+template <typename T>
+struct Inverse4 {
+  const std::array<T, 16> &M;
+  std::array<T, 6> Top{
+      M[0] * M[5] - M[1] * M[4],
+      M[0] * M[6] - M[2] * M[4],
+      M[0] * M[7] - M[3] * M[4],
+      M[1] * M[6] - M[2] * M[5],
+      M[1] * M[7] - M[3] * M[5],
+      M[2] * M[7] - M[3] * M[6],
+  };
+  std::array<T, 6> Bottom{
+      M[8] * M[13] - M[9] * M[12],
+      M[8] * M[14] - M[10] * M[12],
+      M[8] * M[15] - M[11] * M[12],
+      M[9] * M[14] - M[10] * M[13],
+      M[9] * M[15] - M[11] * M[13],
+      M[10] * M[15] - M[11] * M[14],
+  };
+  T Determinant{
+      Top[0] * Bottom[5] - Top[1] * Bottom[4] + Top[2] * Bottom[3] +
+      Top[3] * Bottom[2] - Top[4] * Bottom[1] + Top[5] * Bottom[0]
+  };
+
+  constexpr std::array<T, 16> inverse() const {
+    auto &s{Top};
+    auto &c{Bottom};
+    std::array<T, 16> output{
+        M[5] * c[5] - M[6] * c[4] + M[7] * c[3],
+        -M[1] * c[5] + M[2] * c[4] - M[3] * c[3],
+        M[13] * s[5] - M[14] * s[4] + M[15] * s[3],
+        -M[9] * s[5] + M[10] * s[4] - M[11] * s[3],
+        -M[4] * c[5] + M[6] * c[2] - M[7] * c[1],
+        M[0] * c[5] - M[2] * c[2] + M[3] * c[1],
+        -M[12] * s[5] + M[14] * s[2] - M[15] * s[1],
+        M[8] * s[5] - M[10] * s[2] + M[11] * s[1],
+        M[4] * c[4] - M[5] * c[2] + M[7] * c[0],
+        -M[0] * c[4] + M[1] * c[2] - M[3] * c[0],
+        M[12] * s[4] - M[13] * s[2] + M[15] * s[0],
+        -M[8] * s[4] + M[9] * s[2] - M[11] * s[0],
+        -M[4] * c[3] + M[5] * c[1] - M[6] * c[0],
+        M[0] * c[3] - M[1] * c[1] + M[2] * c[0],
+        -M[12] * s[3] + M[13] * s[1] - M[14] * s[0],
+        M[8] * s[3] - M[9] * s[1] + M[10] * s[0],
+    };
+    auto inverseDeterminant{T{1} / Determinant};
+    for (auto &value : output)
+      value *= inverseDeterminant;
+    return output;
+  }
+};
+
+/** Whether matrix operations on T go through the kernels in `simd.hpp`. */
+template <typename T>
+concept FloatKernels = std::same_as<T, float>;
+
+template <typename T>
+concept Negatable = requires(const T &a) { -a; };
+
+template <typename T>
+concept Scalable = requires(const T &a, const T &b) { a * b; };
+} // namespace impl
+
+template <typename T, size_t R, size_t C>
+class Matrix;
+
+/**
+ * Lazily evaluated result of element-wise operators on matrices.
+ *
+ * `a + b * s - c` builds a small tree of expressions instead of a matrix per
+ * operator, and the tree is evaluated in a single loop over the elements when
+ * it is assigned to a Matrix. Matrix operands are held by reference when they
+ * are lvalues and by value otherwise, so an expression stays valid as long as
+ * the named matrices it refers to.
+ */
+template <typename Derived, typename T, size_t R, size_t C>
+class MatrixExpression {
+  [[nodiscard]] constexpr const Derived &self() const {
+    return static_cast<const Derived &>(*this);
+  }
+
+public:
+  using Value = T;
+  static constexpr size_t Columns{C};
+  static constexpr size_t Rows{R};
+
+  [[nodiscard]] constexpr size_t columns() const { return Columns; }
+  [[nodiscard]] constexpr size_t rows() const { return Rows; }
+
+  constexpr T operator[](std::array<size_t, 2> cell) const {
+    return self().element(cell[0] + cell[1] * Columns);
+  }
+
+  constexpr T operator[](size_t index) const
+    requires(Columns == 1)
+  {
+    return self().element(index);
+  }
+
+  [[nodiscard]] constexpr Matrix<T, R, C> eval() const { return self(); }
+
+  template <typename E>
+  [[nodiscard]] constexpr T dot(const E &other) const
+    requires(Columns == 1)
+  {
+    return eval().dot(other);
+  }
+
+  [[nodiscard]] constexpr T length() const
+    requires(Columns == 1)
+  {
+    return eval().length();
+  }
+
+  [[nodiscard]] constexpr Matrix<T, R, C> normalized() const
+    requires(Columns == 1)
+  {
+    return eval().normalized();
+  }
+};
+
+namespace impl {
+template <typename T>
+constexpr bool IsMatrix{false};
+
+template <typename T, size_t R, size_t C>
+constexpr bool IsMatrix<Matrix<T, R, C>>{true};
+
+template <typename E, typename D = std::remove_cvref_t<E>>
+concept LazyMatrix =
+    requires { typename D::Value; } &&
+    std::derived_from<
+        D,
+        MatrixExpression<D, typename D::Value, D::Rows, D::Columns>>;
+
+/** A Matrix or an expression that evaluates to one. */
+template <typename E>
+concept MatrixOperand = IsMatrix<std::remove_cvref_t<E>> || LazyMatrix<E>;
+
+template <MatrixOperand E>
+using ValueOf = typename std::remove_cvref_t<E>::Value;
+
+template <typename L, typename R>
+concept SameShape =
+    MatrixOperand<L> && MatrixOperand<R> &&
+    std::same_as<ValueOf<L>, ValueOf<R>> &&
+    std::remove_cvref_t<L>::Rows == std::remove_cvref_t<R>::Rows &&
+    std::remove_cvref_t<L>::Columns == std::remove_cvref_t<R>::Columns;
+
+/** How an expression holds an operand passed as `E&&`. */
+template <typename E>
+using Stored = std::conditional_t<
+    std::is_lvalue_reference_v<E> && IsMatrix<std::remove_cvref_t<E>>,
+    const std::remove_cvref_t<E> &,
+    std::remove_cvref_t<E>>;
+
+template <typename T, size_t R, size_t C>
+constexpr const T &element(const Matrix<T, R, C> &matrix, size_t index) {
+  return matrix.data()[index];
+}
+
+template <typename D, typename T, size_t R, size_t C>
+constexpr T
+element(const MatrixExpression<D, T, R, C> &expression, size_t index) {
+  return static_cast<const D &>(expression).element(index);
+}
+
+/** The matrix an operand evaluates to, without copying matrices. */
+template <MatrixOperand E>
+constexpr decltype(auto) evaluate(const E &operand) {
+  if constexpr (IsMatrix<E>)
+    return (operand);
+  else
+    return operand.eval();
+}
 } // namespace impl
 
+template <typename F, typename L, typename R>
+class ElementwiseExpression
+    : public MatrixExpression<
+          ElementwiseExpression<F, L, R>,
+          impl::ValueOf<L>,
+          std::remove_cvref_t<L>::Rows,
+          std::remove_cvref_t<L>::Columns> {
+  impl::Stored<L> m_Lhs;
+  impl::Stored<R> m_Rhs;
+
+public:
+  constexpr ElementwiseExpression(L &&lhs, R &&rhs)
+      : m_Lhs{std::forward<L>(lhs)}, m_Rhs{std::forward<R>(rhs)} {}
+
+  constexpr impl::ValueOf<L> element(size_t index) const {
+    return F{}(impl::element(m_Lhs, index), impl::element(m_Rhs, index));
+  }
+};
+
+template <typename E>
+class NegatedExpression
+    : public MatrixExpression<
+          NegatedExpression<E>,
+          impl::ValueOf<E>,
+          std::remove_cvref_t<E>::Rows,
+          std::remove_cvref_t<E>::Columns> {
+  impl::Stored<E> m_Operand;
+
+public:
+  constexpr explicit NegatedExpression(E &&operand)
+      : m_Operand{std::forward<E>(operand)} {}
+
+  constexpr impl::ValueOf<E> element(size_t index) const {
+    return -impl::element(m_Operand, index);
+  }
+};
+
+template <typename E>
+class ScaledExpression
+    : public MatrixExpression<
+          ScaledExpression<E>,
+          impl::ValueOf<E>,
+          std::remove_cvref_t<E>::Rows,
+          std::remove_cvref_t<E>::Columns> {
+  impl::Stored<E> m_Operand;
+  impl::ValueOf<E> m_Scalar;
+
+public:
+  constexpr ScaledExpression(E &&operand, const impl::ValueOf<E> &scalar)
+      : m_Operand{std::forward<E>(operand)}, m_Scalar{scalar} {}
+
+  constexpr impl::ValueOf<E> element(size_t index) const {
+    return impl::element(m_Operand, index) * m_Scalar;
+  }
+};
+
 template <typename T, size_t R, size_t C>
 class Matrix {
 public:
@@ -32,10 +274,14 @@ public:
   static constexpr size_t Rows{R};
 
 private:
+  template <typename, size_t, size_t>
+  friend class Matrix;
+
+  // row-major: the element in column c of row r is at c + r * Columns
   std::array<T, R * C> m_Data{};
 
   template <std::invocable<const T &, const T &> F>
-  Matrix piecewise(const Matrix &other, F &&f) const {
+  constexpr Matrix piecewise(const Matrix &other, F &&f) const {
     Matrix output;
 
     for (size_t i{0}; i < m_Data.size(); ++i) {
@@ -44,16 +290,75 @@ private:
     return output;
   }
 
+  template <typename E>
+  constexpr void assign(const E &expression) {
+    // a local result cannot alias the operands, which lets compilers
+    // vectorize the loop without runtime overlap checks
+    std::array<T, R * C> values;
+    for (size_t i{0}; i < values.size(); ++i)
+      values[i] = impl::element(expression, i);
+    m_Data = values;
+  }
+
 public:
+  using Value = T;
+
   Matrix() = default;
 
+  /** Evaluates `expression` in a single pass over the elements. */
+  template <impl::LazyMatrix E>
+    requires impl::SameShape<Matrix, E>
+  constexpr Matrix(const E &expression) {
+    assign(expression);
+  }
+
+  /**
+   * Element-wise expressions only read the element they write, so the
+   * expression may refer to this matrix, e.g. `a = b - a`.
+   */
+  template <impl::LazyMatrix E>
+    requires impl::SameShape<Matrix, E>
+  constexpr Matrix &operator=(const E &expression) {
+    assign(expression);
+    return *this;
+  }
+
+  template <typename E>
+    requires impl::SameShape<Matrix, E> && impl::Addable<T>
+  constexpr Matrix &operator+=(const E &expression) {
+    assign(*this + expression);
+    return *this;
+  }
+
+  template <typename E>
+    requires impl::SameShape<Matrix, E> && impl::Subtractible<T>
+  constexpr Matrix &operator-=(const E &expression) {
+    assign(*this - expression);
+    return *this;
+  }
+
+  constexpr Matrix &operator*=(const T &scalar)
+    requires(impl::Scalable<T>)
+  {
+    assign(*this * scalar);
+    return *this;
+  }
+
   template <typename... Args>
-  Matrix(Args &&...args)
+    requires(
+        sizeof...(Args) > 0 && sizeof...(Args) <= R * C &&
+        (std::convertible_to<Args, T> && ...)
+    )
+  constexpr Matrix(Args &&...args)
       : m_Data{(T)std::forward<Args>(args)...} {
   }
 
-  [[nodiscard]] size_t columns() const { return Columns; }
-  [[nodiscard]] size_t rows() const { return Rows; }
+  constexpr T *data() { return m_Data.data(); }
+
+  [[nodiscard]] constexpr const T *data() const { return m_Data.data(); }
+
+  [[nodiscard]] constexpr size_t columns() const { return Columns; }
+  [[nodiscard]] constexpr size_t rows() const { return Rows; }
 
   friend std::ostream &operator<<(std::ostream &os, const Matrix &obj) {
     os << "[ ";
@@ -69,98 +374,98 @@ public:
     return os;
   }
 
-  bool operator==(const Matrix<T, R, C> &other) const {
-    return std::memcmp(m_Data.data(), other.m_Data.data(), sizeof(m_Data)) == 0;
-  }
+  constexpr bool operator==(const Matrix &other) const = default;
 
-  T &at(size_t index)
+  constexpr T &at(size_t index)
     requires(Columns == 1)
   {
     return m_Data[index];
   }
 
-  [[nodiscard]] const T &at(size_t index) const
+  [[nodiscard]] constexpr const T &at(size_t index) const
     requires(Columns == 1)
   {
     return m_Data[index];
   }
 
-  T &at(std::array<size_t, 2> cell) {
+  constexpr T &at(std::array<size_t, 2> cell) {
     auto index{cell[0] + cell[1] * Columns};
     return m_Data[index];
   }
 
-  [[nodiscard]] const T &at(std::array<size_t, 2> cell) const {
+  [[nodiscard]] constexpr const T &at(std::array<size_t, 2> cell) const {
     auto index{cell[0] + cell[1] * Columns};
     return m_Data[index];
   }
 
-  T &operator[](std::array<size_t, 2> cell) { return at(cell); }
+  constexpr T &operator[](std::array<size_t, 2> cell) { return at(cell); }
 
-  const T &operator[](std::array<size_t, 2> cell) const { return at(cell); }
+  constexpr const T &operator[](std::array<size_t, 2> cell) const {
+    return at(cell);
+  }
 
-  T &operator[](size_t index)
+  constexpr T &operator[](size_t index)
     requires(Columns == 1)
   {
     return at(index);
   }
 
-  const T &operator[](size_t index) const
+  constexpr const T &operator[](size_t index) const
     requires(Columns == 1)
   {
     return at(index);
   }
 
-  T &x()
+  constexpr T &x()
     requires(Columns == 1)
   {
     return at(0);
   }
 
-  [[nodiscard]] const T &x() const
+  [[nodiscard]] constexpr const T &x() const
     requires(Columns == 1)
   {
     return at(0);
   }
 
-  T &y()
+  constexpr T &y()
     requires(Columns == 1 && Rows > 1)
   {
     return at(1);
   }
 
-  [[nodiscard]] const T &y() const
+  [[nodiscard]] constexpr const T &y() const
     requires(Columns == 1 && Rows > 1)
   {
     return at(1);
   }
 
-  T &z()
+  constexpr T &z()
     requires(Columns == 1 && Rows > 2)
   {
     return at(2);
   }
 
-  [[nodiscard]] const T &z() const
+  [[nodiscard]] constexpr const T &z() const
     requires(Columns == 1 && Rows > 2)
   {
     return at(2);
   }
 
-  T &w()
+  constexpr T &w()
     requires(Columns == 1 && Rows > 3)
   {
     return at(3);
   }
 
-  [[nodiscard]] const T &w() const
+  [[nodiscard]] constexpr const T &w() const
     requires(Columns == 1 && Rows > 3)
   {
-    return at(4);
+    return at(3);
   }
 
   template <size_t R2, size_t C2>
-  Matrix<T, R2, C2>
+  constexpr Matrix<T, R2, C2>
   subMatrix(const Matrix<size_t, 2, 1> &offset = {0u, 0u}) const {
     Matrix<T, R2, C2> output;
     for (size_t row{0}; row < R2; ++row) {
@@ -171,56 +476,253 @@ public:
     return output;
   }
 
-  Matrix<T, R, 1> column(size_t c) const { return subMatrix<R, 1>({c, 0}); }
+  constexpr Matrix<T, R, 1> column(size_t c) const {
+    return subMatrix<R, 1>({c, 0});
+  }
 
-  Matrix<T, 1, C> row(size_t r) const { return subMatrix<1, C>({0, r}); }
+  constexpr Matrix<T, 1, C> row(size_t r) const {
+    return subMatrix<1, C>({0, r});
+  }
 
-  [[nodiscard]] Matrix add(const Matrix &other) const
+  [[nodiscard]] constexpr Matrix add(const Matrix &other) const
     requires(impl::Addable<T>)
   {
-    return piecewise(other, &impl::add<T>);
+    if constexpr (impl::FloatKernels<T>) {
+      if !consteval {
+        Matrix output;
+        simd::add(data(), other.data(), output.data(), R * C);
+        return output;
+      }
+    }
+    return piecewise(other, std::plus<>{});
   }
 
-  Matrix operator+(const Matrix &other) const { return add(other); }
-
-  [[nodiscard]] Matrix subtract(const Matrix &other) const
+  [[nodiscard]] constexpr Matrix subtract(const Matrix &other) const
     requires(impl::Subtractible<T>)
   {
-    return piecewise(other, &impl::subtract<T>);
+    if constexpr (impl::FloatKernels<T>) {
+      if !consteval {
+        Matrix output;
+        simd::subtract(data(), other.data(), output.data(), R * C);
+        return output;
+      }
+    }
+    return piecewise(other, std::minus<>{});
   }
 
-  Matrix operator-(const Matrix &other) const { return subtract(other); }
+  [[nodiscard]] constexpr Matrix scale(const T &scalar) const {
+    Matrix output;
+    if constexpr (impl::FloatKernels<T>) {
+      if !consteval {
+        simd::scale(data(), scalar, output.data(), R * C);
+        return output;
+      }
+    }
+    for (size_t i{0}; i < m_Data.size(); ++i)
+      output.m_Data[i] = m_Data[i] * scalar;
+    return output;
+  }
 
-  Matrix operator-() const { return Matrix{} - *this; }
+  /** Standard matrix product: this matrix applied after `rhs`. */
+  template <size_t N>
+  constexpr Matrix<T, R, N> operator*(const Matrix<T, C, N> &rhs) const {
+    Matrix<T, R, N> output;
+    if constexpr (impl::FloatKernels<T> && R == 4 && C == 4) {
+      if !consteval {
+        if constexpr (N == 4)
+          simd::multiply4x4(data(), rhs.data(), output.data());
+        else if constexpr (N == 1)
+          simd::transform4(data(), rhs.data(), output.data());
+        if constexpr (N == 4 || N == 1)
+          return output;
+      }
+    }
+    for (size_t row{0}; row < R; ++row) {
+      for (size_t k{0}; k < C; ++k) {
+        auto lhs{m_Data[row * C + k]};
+        for (size_t column{0}; column < N; ++column)
+          output.m_Data[row * N + column] += lhs * rhs.m_Data[k * N + column];
+      }
+    }
+    return output;
+  }
 
-  [[nodiscard]] Matrix<T, R, 1> multiply(const Matrix<T, R, 1> &rhs) const
+  [[nodiscard]] constexpr Matrix<T, R, 1>
+  multiply(const Matrix<T, R, 1> &rhs) const
     requires(R == C)
   {
-    Matrix<T, R, 1> output{0};
-    for (size_t dim{0}; dim < R; ++dim) {
-      auto basis{column(dim)};
-      auto component{rhs[dim]};
-      for (size_t row{0}; row < R; ++row) {
-        output[row] += component * basis[row];
+    return *this * rhs;
+  }
+
+  [[nodiscard]] constexpr Matrix<T, C, R> transpose() const {
+    Matrix<T, C, R> output;
+    if constexpr (impl::FloatKernels<T> && R == 4 && C == 4) {
+      if !consteval {
+        simd::transpose4x4(data(), output.data());
+        return output;
       }
     }
+    for (size_t row{0}; row < R; ++row) {
+      for (size_t column{0}; column < C; ++column)
+        output.m_Data[column * R + row] = m_Data[row * C + column];
+    }
     return output;
   }
 
-  Matrix operator*(const Matrix &rhs) const {
+  [[nodiscard]] constexpr T determinant() const
+    requires(R == 4 && C == 4)
+  {
+    return impl::Inverse4<T>{m_Data}.Determinant;
+  }
+
+  /** Closed-form inverse; the matrix must be invertible. */
+  [[nodiscard]] constexpr Matrix inverse() const
+    requires(R == 4 && C == 4)
+  {
+    Matrix output;
+    output.m_Data = impl::Inverse4<T>{m_Data}.inverse();
+    return output;
+  }
+
+  /**
+   * Inverse of an affine transform, whose last row is (0, 0, 0, 1). Only
+   * inverts the upper 3x3 block and negates the translation, so it is
+   * cheaper than `inverse()`.
+   */
+  [[nodiscard]] constexpr Matrix affineInverse() const
+    requires(R == 4 && C == 4)
+  {
+    auto &m{m_Data};
+    // cofactors of the upper 3x3 block, transposed
+    std::array<T, 9> adjugate{
+        m[5] * m[10] - m[6] * m[9],
+        m[2] * m[9] - m[1] * m[10],
+        m[1] * m[6] - m[2] * m[5],
+        m[6] * m[8] - m[4] * m[10],
+        m[0] * m[10] - m[2] * m[8],
+        m[2] * m[4] - m[0] * m[6],
+        m[4] * m[9] - m[5] * m[8],
+        m[1] * m[8] - m[0] * m[9],
+        m[0] * m[5] - m[1] * m[4],
+    };
+    auto inverseDeterminant{
+        T{1} / (m[0] * adjugate[0] + m[1] * adjugate[3] + m[2] * adjugate[6])
+    };
+
     Matrix output;
-    size_t n{C};
-    for (size_t i{0}; i < C; ++i) {
-      for (size_t j{0}; j < R; ++j) {
-        for (size_t k{0}; k < n; ++k) {
-          output[{i, j}] += at({i, k}) * rhs[{k, j}];
-        }
+    for (size_t row{0}; row < 3; ++row) {
+      T translation{};
+      for (size_t column{0}; column < 3; ++column) {
+        auto value{adjugate[row * 3 + column] * inverseDeterminant};
+        output.m_Data[row * 4 + column] = value;
+        translation -= value * m[column * 4 + 3];
       }
+      output.m_Data[row * 4 + 3] = translation;
     }
+    output.m_Data[15] = T{1};
     return output;
   }
+
+  [[nodiscard]] constexpr T dot(const Matrix &other) const
+    requires(Columns == 1)
+  {
+    if constexpr (impl::FloatKernels<T> && (R == 3 || R == 4)) {
+      if !consteval {
+        if constexpr (R == 3)
+          return simd::dot3(data(), other.data());
+        else
+          return simd::dot4(data(), other.data());
+      }
+    }
+    T sum{};
+    for (size_t i{0}; i < R; ++i)
+      sum += m_Data[i] * other.m_Data[i];
+    return sum;
+  }
+
+  [[nodiscard]] constexpr Matrix cross(const Matrix &other) const
+    requires(Columns == 1 && Rows == 3)
+  {
+    Matrix output;
+    if constexpr (impl::FloatKernels<T>) {
+      if !consteval {
+        simd::cross3(data(), other.data(), output.data());
+        return output;
+      }
+    }
+    output.x() = y() * other.z() - z() * other.y();
+    output.y() = z() * other.x() - x() * other.z();
+    output.z() = x() * other.y() - y() * other.x();
+    return output;
+  }
+
+  [[nodiscard]] constexpr T length() const
+    requires(Columns == 1)
+  {
+    return std::sqrt(dot(*this));
+  }
+
+  [[nodiscard]] constexpr Matrix normalized() const
+    requires(Columns == 1)
+  {
+    if constexpr (impl::FloatKernels<T> && (R == 3 || R == 4)) {
+      if !consteval {
+        Matrix output;
+        simd::normalize<R>(data(), output.data());
+        return output;
+      }
+    }
+    return scale(T{1} / length());
+  }
 };
 
+template <typename L, typename R>
+  requires impl::SameShape<L, R> && impl::Addable<impl::ValueOf<L>>
+constexpr ElementwiseExpression<std::plus<>, L, R>
+operator+(L &&lhs, R &&rhs) {
+  return {std::forward<L>(lhs), std::forward<R>(rhs)};
+}
+
+template <typename L, typename R>
+  requires impl::SameShape<L, R> && impl::Subtractible<impl::ValueOf<L>>
+constexpr ElementwiseExpression<std::minus<>, L, R>
+operator-(L &&lhs, R &&rhs) {
+  return {std::forward<L>(lhs), std::forward<R>(rhs)};
+}
+
+template <impl::MatrixOperand E>
+  requires impl::Negatable<impl::ValueOf<E>>
+constexpr NegatedExpression<E> operator-(E &&operand) {
+  return NegatedExpression<E>{std::forward<E>(operand)};
+}
+
+template <impl::MatrixOperand E>
+  requires impl::Scalable<impl::ValueOf<E>>
+constexpr ScaledExpression<E>
+operator*(E &&operand, const impl::ValueOf<E> &scalar) {
+  return {std::forward<E>(operand), scalar};
+}
+
+template <impl::MatrixOperand E>
+  requires impl::Scalable<impl::ValueOf<E>>
+constexpr ScaledExpression<E>
+operator*(const impl::ValueOf<E> &scalar, E &&operand) {
+  return {std::forward<E>(operand), scalar};
+}
+
+/**
+ * Products read every operand element several times, so expressions are
+ * evaluated once before multiplying rather than per use.
+ */
+template <typename L, typename R>
+  requires(impl::LazyMatrix<L> || impl::LazyMatrix<R>) &&
+          impl::MatrixOperand<L> && impl::MatrixOperand<R> &&
+          std::same_as<impl::ValueOf<L>, impl::ValueOf<R>> &&
+          (std::remove_cvref_t<L>::Columns == std::remove_cvref_t<R>::Rows)
+constexpr auto operator*(const L &lhs, const R &rhs) {
+  return impl::evaluate(lhs) * impl::evaluate(rhs);
+}
+
 template <typename T>
 using Matrix4 = Matrix<T, 4, 4>;
 
@@ -247,9 +749,28 @@ using Vec4 = Vector<T, 4>;
 using Vec4f = Vec4<float>;
 using Vec4i = Vec4<int>;
 
+namespace impl {
+/** Rotation matrix of the unit quaternion (x, y, z, w). */
+template <typename T>
+constexpr Matrix4<T> rotationFromQuaternion(T x, T y, T z, T w) {
+  // clang-format off
+  return {
+    1 - 2 * (y * y + z * z), 2 * (x * y - z * w),     2 * (x * z + y * w),     0,
+    2 * (x * y + z * w),     1 - 2 * (x * x + z * z), 2 * (y * z - x * w),     0,
+    2 * (x * z - y * w),     2 * (y * z + x * w),     1 - 2 * (x * x + y * y), 0,
+    0,                       0,                       0,                       1,
+  };
+  // clang-format on
+}
+} // namespace impl
+
+/**
+ * Builders for common transforms. They follow the column-vector convention
+ * (`matrix * vector`), are right-handed and produce OpenGL clip space.
+ */
 namespace matrix {
 template <typename T, size_t S>
-Matrix<T, S, S> identity() {
+constexpr Matrix<T, S, S> identity() {
   Matrix<T, S, S> output;
   for (size_t r{0}; r < S; ++r)
     output[{r, r}] = 1.0;
@@ -257,7 +778,7 @@ Matrix<T, S, S> identity() {
 }
 
 template <typename T>
-Matrix4<T> translation(const Vec3<T> &translation) {
+constexpr Matrix4<T> translation(const Vec3<T> &translation) {
   auto output{identity<T, 4>()};
   output[{3, 0}] = translation.x();
   output[{3, 1}] = translation.y();
@@ -266,7 +787,7 @@ Matrix4<T> translation(const Vec3<T> &translation) {
 }
 
 template <typename T>
-Matrix4<T> scale(const T &scalar) {
+constexpr Matrix4<T> scale(const T &scalar) {
   auto output{identity<T, 4>()};
   output[{0, 0}] = scalar;
   output[{1, 1}] = scalar;
@@ -275,12 +796,73 @@ Matrix4<T> scale(const T &scalar) {
 }
 
 template <typename T>
-Matrix4<T> scale(const Vector<T, 3> &scale) {
+constexpr Matrix4<T> scale(const Vector<T, 3> &scale) {
   auto output{identity<T, 4>()};
   output[{0, 0}] = scale.x();
   output[{1, 1}] = scale.y();
   output[{2, 2}] = scale.z();
   return output;
 }
+
+/** Rotation by `angle` radians around `axis`, built from a quaternion. */
+template <typename T>
+constexpr Matrix4<T> rotation(const Vec3<T> &axis, T angle) {
+  auto unit{axis.normalized()};
+  auto sine{std::sin(angle / 2)};
+  return impl::rotationFromQuaternion(
+      unit.x() * sine, unit.y() * sine, unit.z() * sine, std::cos(angle / 2)
+  );
+}
+
+/**
+ * Maps the box [left, right] x [bottom, top] x [-nearPlane, -farPlane] to
+ * clip space.
+ */
+template <typename T>
+constexpr Matrix4<T> orthographic(
+    T left, T right, T bottom, T top, T nearPlane, T farPlane
+) {
+  Matrix4<T> output;
+  output[{0, 0}] = 2 / (right - left);
+  output[{1, 1}] = 2 / (top - bottom);
+  output[{2, 2}] = -2 / (farPlane - nearPlane);
+  output[{3, 0}] = -(right + left) / (right - left);
+  output[{3, 1}] = -(top + bottom) / (top - bottom);
+  output[{3, 2}] = -(farPlane + nearPlane) / (farPlane - nearPlane);
+  output[{3, 3}] = 1;
+  return output;
+}
+
+/** `fieldOfView` is the vertical angle in radians. */
+template <typename T>
+constexpr Matrix4<T>
+perspective(T fieldOfView, T aspect, T nearPlane, T farPlane) {
+  auto focalLength{1 / std::tan(fieldOfView / 2)};
+  Matrix4<T> output;
+  output[{0, 0}] = focalLength / aspect;
+  output[{1, 1}] = focalLength;
+  output[{2, 2}] = (farPlane + nearPlane) / (nearPlane - farPlane);
+  output[{3, 2}] = 2 * farPlane * nearPlane / (nearPlane - farPlane);
+  output[{2, 3}] = -1;
+  return output;
+}
+
+/** View matrix of a camera at `eye` looking at `target`. */
+template <typename T>
+constexpr Matrix4<T>
+lookAt(const Vec3<T> &eye, const Vec3<T> &target, const Vec3<T> &up) {
+  auto forward{(target - eye).normalized()};
+  auto side{forward.cross(up).normalized()};
+  auto cameraUp{side.cross(forward)};
+
+  // clang-format off
+  return {
+    side.x(),      side.y(),      side.z(),      -side.dot(eye),
+    cameraUp.x(),  cameraUp.y(),  cameraUp.z(),  -cameraUp.dot(eye),
+    -forward.x(),  -forward.y(),  -forward.z(),  forward.dot(eye),
+    0,             0,             0,             1,
+  };
+  // clang-format on
+}
 } // namespace matrix
 } // namespace solaris
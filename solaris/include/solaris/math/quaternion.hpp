@@ -0,0 +1,278 @@
+#pragma once
+
+#include "matrix.hpp"
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <span>
+
+namespace solaris {
+/** Quaternion x i + y j + z k + w; unit quaternions represent rotations. */
+template <typename T>
+class Quat {
+  std::array<T, 4> m_Data{0, 0, 0, 1};
+
+public:
+  constexpr Quat() = default;
+
+  constexpr Quat(T x, T y, T z, T w) : m_Data{x, y, z, w} {}
+
+  constexpr Quat(const Vec3<T> &vector, T w)
+      : m_Data{vector.x(), vector.y(), vector.z(), w} {}
+
+  /** Rotation by `angle` radians around `axis`. */
+  static constexpr Quat fromAxisAngle(const Vec3<T> &axis, T angle) {
+    return {axis.normalized() * std::sin(angle / 2), std::cos(angle / 2)};
+  }
+
+  /** Rotation of the upper 3x3 block, which must be orthonormal. */
+  static constexpr Quat fromMatrix(const Matrix4<T> &m) {
+    auto trace{m[{0, 0}] + m[{1, 1}] + m[{2, 2}]};
+    // pick the largest component to divide by, for stability
+    if (trace > 0) {
+      auto s{std::sqrt(trace + 1) * 2};
+      return {
+          (m[{1, 2}] - m[{2, 1}]) / s,
+          (m[{2, 0}] - m[{0, 2}]) / s,
+          (m[{0, 1}] - m[{1, 0}]) / s,
+          s / 4,
+      };
+    }
+    if (m[{0, 0}] > m[{1, 1}] && m[{0, 0}] > m[{2, 2}]) {
+      auto s{std::sqrt(1 + m[{0, 0}] - m[{1, 1}] - m[{2, 2}]) * 2};
+      return {
+          s / 4,
+          (m[{1, 0}] + m[{0, 1}]) / s,
+          (m[{2, 0}] + m[{0, 2}]) / s,
+          (m[{1, 2}] - m[{2, 1}]) / s,
+      };
+    }
+    if (m[{1, 1}] > m[{2, 2}]) {
+      auto s{std::sqrt(1 + m[{1, 1}] - m[{0, 0}] - m[{2, 2}]) * 2};
+      return {
+          (m[{1, 0}] + m[{0, 1}]) / s,
+          s / 4,
+          (m[{2, 1}] + m[{1, 2}]) / s,
+          (m[{2, 0}] - m[{0, 2}]) / s,
+      };
+    }
+    auto s{std::sqrt(1 + m[{2, 2}] - m[{0, 0}] - m[{1, 1}]) * 2};
+    return {
+        (m[{2, 0}] + m[{0, 2}]) / s,
+        (m[{2, 1}] + m[{1, 2}]) / s,
+        s / 4,
+        (m[{0, 1}] - m[{1, 0}]) / s,
+    };
+  }
+
+  constexpr T *data() { return m_Data.data(); }
+
+  [[nodiscard]] constexpr const T *data() const { return m_Data.data(); }
+
+  constexpr T &x() { return m_Data[0]; }
+  [[nodiscard]] constexpr const T &x() const { return m_Data[0]; }
+
+  constexpr T &y() { return m_Data[1]; }
+  [[nodiscard]] constexpr const T &y() const { return m_Data[1]; }
+
+  constexpr T &z() { return m_Data[2]; }
+  [[nodiscard]] constexpr const T &z() const { return m_Data[2]; }
+
+  constexpr T &w() { return m_Data[3]; }
+  [[nodiscard]] constexpr const T &w() const { return m_Data[3]; }
+
+  /** The imaginary part (x, y, z). */
+  [[nodiscard]] constexpr Vec3<T> vector() const { return {x(), y(), z()}; }
+
+  constexpr bool operator==(const Quat &other) const = default;
+
+  constexpr Quat operator+(const Quat &other) const {
+    return {
+        x() + other.x(),
+        y() + other.y(),
+        z() + other.z(),
+        w() + other.w(),
+    };
+  }
+
+  constexpr Quat operator-(const Quat &other) const {
+    return {
+        x() - other.x(),
+        y() - other.y(),
+        z() - other.z(),
+        w() - other.w(),
+    };
+  }
+
+  constexpr Quat operator-() const { return {-x(), -y(), -z(), -w()}; }
+
+  constexpr Quat operator*(const T &scalar) const {
+    return {x() * scalar, y() * scalar, z() * scalar, w() * scalar};
+  }
+
+  /** Hamilton product: the rotation `rhs` followed by this one. */
+  constexpr Quat operator*(const Quat &rhs) const {
+    return {
+        w() * rhs.x() + x() * rhs.w() + y() * rhs.z() - z() * rhs.y(),
+        w() * rhs.y() - x() * rhs.z() + y() * rhs.w() + z() * rhs.x(),
+        w() * rhs.z() + x() * rhs.y() - y() * rhs.x() + z() * rhs.w(),
+        w() * rhs.w() - x() * rhs.x() - y() * rhs.y() - z() * rhs.z(),
+    };
+  }
+
+  [[nodiscard]] constexpr T dot(const Quat &other) const {
+    return x() * other.x() + y() * other.y() + z() * other.z() +
+           w() * other.w();
+  }
+
+  [[nodiscard]] constexpr T length() const { return std::sqrt(dot(*this)); }
+
+  [[nodiscard]] constexpr Quat normalized() const {
+    return *this * (T{1} / length());
+  }
+
+  [[nodiscard]] constexpr Quat conjugate() const {
+    return {-x(), -y(), -z(), w()};
+  }
+
+  [[nodiscard]] constexpr Quat inverse() const {
+    return conjugate() * (T{1} / dot(*this));
+  }
+
+  /** Rotates `vector` by this unit quaternion. */
+  [[nodiscard]] constexpr Vec3<T> rotate(const Vec3<T> &vector) const {
+    // v + 2 q.xyz x (q.xyz x v + w v)
+    auto axis{this->vector()};
+    auto twice{axis.cross(vector) * T{2}};
+    return vector + twice * w() + axis.cross(twice);
+  }
+
+  [[nodiscard]] constexpr Matrix4<T> toMatrix() const {
+    return impl::rotationFromQuaternion(x(), y(), z(), w());
+  }
+};
+
+using Quatf = Quat<float>;
+
+/**
+ * Rigid transform as a dual quaternion real + dual ε, where real is the
+ * rotation and dual is half the translation times the rotation. Blending
+ * dual quaternions linearly and normalizing keeps skinned volumes intact,
+ * unlike blending matrices.
+ */
+template <typename T>
+class DualQuat {
+  Quat<T> m_Real{};
+  Quat<T> m_Dual{0, 0, 0, 0};
+
+public:
+  constexpr DualQuat() = default;
+
+  constexpr DualQuat(const Quat<T> &real, const Quat<T> &dual)
+      : m_Real{real}, m_Dual{dual} {}
+
+  /** Rotation `rotation` followed by translation `translation`. */
+  static constexpr DualQuat fromRotationTranslation(
+      const Quat<T> &rotation, const Vec3<T> &translation
+  ) {
+    return {rotation, Quat<T>{translation, 0} * rotation * T{0.5}};
+  }
+
+  /** The matrix must be a rotation followed by a translation. */
+  static constexpr DualQuat fromMatrix(const Matrix4<T> &m) {
+    return fromRotationTranslation(
+        Quat<T>::fromMatrix(m), {m[{3, 0}], m[{3, 1}], m[{3, 2}]}
+    );
+  }
+
+  [[nodiscard]] constexpr const Quat<T> &real() const { return m_Real; }
+
+  [[nodiscard]] constexpr const Quat<T> &dual() const { return m_Dual; }
+
+  [[nodiscard]] constexpr Quat<T> rotation() const { return m_Real; }
+
+  [[nodiscard]] constexpr Vec3<T> translation() const {
+    return (m_Dual * m_Real.conjugate() * T{2}).vector();
+  }
+
+  constexpr bool operator==(const DualQuat &other) const = default;
+
+  constexpr DualQuat operator+(const DualQuat &other) const {
+    return {m_Real + other.m_Real, m_Dual + other.m_Dual};
+  }
+
+  constexpr DualQuat operator*(const T &scalar) const {
+    return {m_Real * scalar, m_Dual * scalar};
+  }
+
+  /** The transform `rhs` followed by this one. */
+  constexpr DualQuat operator*(const DualQuat &rhs) const {
+    return {
+        m_Real * rhs.m_Real,
+        m_Real * rhs.m_Dual + m_Dual * rhs.m_Real,
+    };
+  }
+
+  /** Scales both parts so the rotation is a unit quaternion. */
+  [[nodiscard]] constexpr DualQuat normalized() const {
+    return *this * (T{1} / m_Real.length());
+  }
+
+  [[nodiscard]] constexpr Vec3<T> transformPoint(const Vec3<T> &point) const {
+    return m_Real.rotate(point) + translation();
+  }
+
+  [[nodiscard]] constexpr Matrix4<T> toMatrix() const {
+    auto output{m_Real.toMatrix()};
+    auto offset{translation()};
+    output[{3, 0}] = offset.x();
+    output[{3, 1}] = offset.y();
+    output[{3, 2}] = offset.z();
+    return output;
+  }
+};
+
+using DualQuatf = DualQuat<float>;
+
+/** Interpolation between rotations along the shorter arc. */
+namespace quaternion {
+/** Normalized linear interpolation: cheap, but not at constant speed. */
+template <typename T>
+constexpr Quat<T> nlerp(const Quat<T> &from, const Quat<T> &to, T t) {
+  auto target{from.dot(to) < 0 ? -to : to};
+  return (from * (1 - t) + target * t).normalized();
+}
+
+/** Spherical linear interpolation, at constant angular speed. */
+template <typename T>
+constexpr Quat<T> slerp(const Quat<T> &from, const Quat<T> &to, T t) {
+  auto cosine{from.dot(to)};
+  auto target{cosine < 0 ? -to : to};
+  cosine = std::abs(cosine);
+
+  // nearly parallel: the sine below would vanish
+  if (cosine > T{0.9995})
+    return nlerp(from, target, t);
+
+  auto angle{std::acos(cosine)};
+  auto sine{std::sin(angle)};
+  return from * (std::sin((1 - t) * angle) / sine) +
+         target * (std::sin(t * angle) / sine);
+}
+
+/** Weighted blend of skinning transforms, e.g. the bones of a vertex. */
+template <typename T>
+constexpr DualQuat<T>
+blend(std::span<const DualQuat<T>> transforms, std::span<const T> weights) {
+  DualQuat<T> sum{Quat<T>{0, 0, 0, 0}, Quat<T>{0, 0, 0, 0}};
+  for (size_t i{0}; i < transforms.size(); ++i) {
+    // keep every rotation in the same hemisphere as the first
+    auto weight{weights[i]};
+    if (transforms[i].real().dot(transforms[0].real()) < 0)
+      weight = -weight;
+    sum = sum + transforms[i] * weight;
+  }
+  return sum.normalized();
+}
+} // namespace quaternion
+} // namespace solaris
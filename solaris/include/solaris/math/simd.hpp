@@ -0,0 +1,579 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+/**
+ * Float kernels behind `Matrix4f`, `Vec3f` and `Vec4f`. The instruction set is
+ * picked at compile time: AVX or SSE when the target has them, plain loops
+ * otherwise or when `SOLARIS_NO_SIMD` is defined. All matrices are row-major
+ * and all loads are unaligned, so the kernels work on any float storage.
+ */
+#if !defined(SOLARIS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define SOLARIS_SIMD_SSE 1
+#include <immintrin.h>
+#if defined(__AVX__)
+#define SOLARIS_SIMD_AVX 1
+#endif
+#endif
+
+namespace solaris::simd {
+#if SOLARIS_SIMD_SSE
+namespace impl {
+inline __m128 load3(const float *source) {
+  auto xy{_mm_loadl_pi(
+      _mm_setzero_ps(), reinterpret_cast<const __m64 *>(source)
+  )};
+  return _mm_movelh_ps(xy, _mm_load_ss(source + 2));
+}
+
+inline void store3(float *destination, __m128 value) {
+  _mm_storel_pi(reinterpret_cast<__m64 *>(destination), value);
+  _mm_store_ss(destination + 2, _mm_movehl_ps(value, value));
+}
+
+/** Sum of all four lanes, in every lane. */
+inline __m128 horizontalSum(__m128 value) {
+  auto pairs{
+      _mm_add_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1)))
+  };
+  return _mm_add_ps(
+      pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 0, 3, 2))
+  );
+}
+
+template <int Lane>
+__m128 splat(__m128 value) {
+  return _mm_shuffle_ps(value, value, _MM_SHUFFLE(Lane, Lane, Lane, Lane));
+}
+
+/** output = x * rows[0] + y * rows[1] + z * rows[2] + w * rows[3] */
+inline __m128 combine(const __m128 (&rows)[4], __m128 vector) {
+  auto output{_mm_mul_ps(splat<0>(vector), rows[0])};
+  output = _mm_add_ps(output, _mm_mul_ps(splat<1>(vector), rows[1]));
+  output = _mm_add_ps(output, _mm_mul_ps(splat<2>(vector), rows[2]));
+  return _mm_add_ps(output, _mm_mul_ps(splat<3>(vector), rows[3]));
+}
+} // namespace impl
+#endif
+
+inline void add(const float *a, const float *b, float *output, size_t count) {
+  size_t i{0};
+#if SOLARIS_SIMD_SSE
+  for (; i < (count & ~size_t{3}); i += 4) {
+    _mm_storeu_ps(
+        output + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i))
+    );
+  }
+#endif
+  for (; i < count; ++i)
+    output[i] = a[i] + b[i];
+}
+
+inline void
+subtract(const float *a, const float *b, float *output, size_t count) {
+  size_t i{0};
+#if SOLARIS_SIMD_SSE
+  for (; i < (count & ~size_t{3}); i += 4) {
+    _mm_storeu_ps(
+        output + i, _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i))
+    );
+  }
+#endif
+  for (; i < count; ++i)
+    output[i] = a[i] - b[i];
+}
+
+inline void scale(const float *a, float scalar, float *output, size_t count) {
+  size_t i{0};
+#if SOLARIS_SIMD_SSE
+  auto factor{_mm_set1_ps(scalar)};
+  for (; i < (count & ~size_t{3}); i += 4)
+    _mm_storeu_ps(output + i, _mm_mul_ps(_mm_loadu_ps(a + i), factor));
+#endif
+  for (; i < count; ++i)
+    output[i] = a[i] * scalar;
+}
+
+/** output = a * b for row-major 4x4 matrices. */
+inline void multiply4x4(const float *a, const float *b, float *output) {
+#if SOLARIS_SIMD_AVX
+  // two rows of the output per iteration, one in each 128-bit lane
+  __m256 rows[4];
+  for (size_t k{0}; k < 4; ++k)
+    rows[k] = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>(b + 4 * k)
+    );
+
+  for (size_t i{0}; i < 4; i += 2) {
+    auto lhs{_mm256_loadu_ps(a + 4 * i)};
+    auto result{_mm256_mul_ps(_mm256_permute_ps(lhs, 0x00), rows[0])};
+    result = _mm256_add_ps(
+        result, _mm256_mul_ps(_mm256_permute_ps(lhs, 0x55), rows[1])
+    );
+    result = _mm256_add_ps(
+        result, _mm256_mul_ps(_mm256_permute_ps(lhs, 0xAA), rows[2])
+    );
+    result = _mm256_add_ps(
+        result, _mm256_mul_ps(_mm256_permute_ps(lhs, 0xFF), rows[3])
+    );
+    _mm256_storeu_ps(output + 4 * i, result);
+  }
+#elif SOLARIS_SIMD_SSE
+  const __m128 rows[4]{
+      _mm_loadu_ps(b),
+      _mm_loadu_ps(b + 4),
+      _mm_loadu_ps(b + 8),
+      _mm_loadu_ps(b + 12),
+  };
+  for (size_t i{0}; i < 4; ++i) {
+    auto row{impl::combine(rows, _mm_loadu_ps(a + 4 * i))};
+    _mm_storeu_ps(output + 4 * i, row);
+  }
+#else
+  for (size_t i{0}; i < 4; ++i) {
+    for (size_t j{0}; j < 4; ++j) {
+      float sum{0};
+      for (size_t k{0}; k < 4; ++k)
+        sum += a[4 * i + k] * b[4 * k + j];
+      output[4 * i + j] = sum;
+    }
+  }
+#endif
+}
+
+inline void transpose4x4(const float *m, float *output) {
+#if SOLARIS_SIMD_SSE
+  auto row0{_mm_loadu_ps(m)};
+  auto row1{_mm_loadu_ps(m + 4)};
+  auto row2{_mm_loadu_ps(m + 8)};
+  auto row3{_mm_loadu_ps(m + 12)};
+  _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+  _mm_storeu_ps(output, row0);
+  _mm_storeu_ps(output + 4, row1);
+  _mm_storeu_ps(output + 8, row2);
+  _mm_storeu_ps(output + 12, row3);
+#else
+  float result[16];
+  for (size_t row{0}; row < 4; ++row) {
+    for (size_t column{0}; column < 4; ++column)
+      result[column * 4 + row] = m[row * 4 + column];
+  }
+  for (size_t i{0}; i < 16; ++i)
+    output[i] = result[i];
+#endif
+}
+
+/** output = m * v for a row-major 4x4 matrix and a 4-vector. */
+inline void transform4(const float *m, const float *v, float *output) {
+#if SOLARIS_SIMD_SSE
+  __m128 columns[4]{
+      _mm_loadu_ps(m),
+      _mm_loadu_ps(m + 4),
+      _mm_loadu_ps(m + 8),
+      _mm_loadu_ps(m + 12),
+  };
+  _MM_TRANSPOSE4_PS(columns[0], columns[1], columns[2], columns[3]);
+  _mm_storeu_ps(output, impl::combine(columns, _mm_loadu_ps(v)));
+#else
+  float result[4];
+  for (size_t i{0}; i < 4; ++i) {
+    result[i] = m[4 * i] * v[0] + m[4 * i + 1] * v[1] + m[4 * i + 2] * v[2] +
+                m[4 * i + 3] * v[3];
+  }
+  for (size_t i{0}; i < 4; ++i)
+    output[i] = result[i];
+#endif
+}
+
+/**
+ * output[i] = m * vectors[i] for `count` 4-vectors stored back to back. With
+ * AVX two vectors are transformed per instruction, one in each 128-bit lane.
+ */
+inline void transform4Batch(
+    const float *m, const float *vectors, float *output, size_t count
+) {
+#if SOLARIS_SIMD_SSE
+  __m128 columns[4]{
+      _mm_loadu_ps(m),
+      _mm_loadu_ps(m + 4),
+      _mm_loadu_ps(m + 8),
+      _mm_loadu_ps(m + 12),
+  };
+  _MM_TRANSPOSE4_PS(columns[0], columns[1], columns[2], columns[3]);
+
+  size_t i{0};
+#if SOLARIS_SIMD_AVX
+  __m256 wide[4];
+  for (size_t k{0}; k < 4; ++k)
+    wide[k] = _mm256_set_m128(columns[k], columns[k]);
+
+  for (; i < (count & ~size_t{1}); i += 2) {
+    auto pair{_mm256_loadu_ps(vectors + 4 * i)};
+    auto result{_mm256_mul_ps(_mm256_permute_ps(pair, 0x00), wide[0])};
+    result = _mm256_add_ps(
+        result, _mm256_mul_ps(_mm256_permute_ps(pair, 0x55), wide[1])
+    );
+    result = _mm256_add_ps(
+        result, _mm256_mul_ps(_mm256_permute_ps(pair, 0xAA), wide[2])
+    );
+    result = _mm256_add_ps(
+        result, _mm256_mul_ps(_mm256_permute_ps(pair, 0xFF), wide[3])
+    );
+    _mm256_storeu_ps(output + 4 * i, result);
+  }
+#endif
+  for (; i < count; ++i) {
+    auto result{impl::combine(columns, _mm_loadu_ps(vectors + 4 * i))};
+    _mm_storeu_ps(output + 4 * i, result);
+  }
+#else
+  for (size_t i{0}; i < count; ++i)
+    transform4(m, vectors + 4 * i, output + 4 * i);
+#endif
+}
+
+/**
+ * output[i] = matrices[i] * vectors[i] for `count` row-major 4x4 matrices
+ * and 4-vectors stored back to back. SSE transforms four vectors at once,
+ * transposing them so that each register holds one coordinate of four
+ * vectors and each matrix entry is applied to all of them.
+ */
+inline void transform4Each(
+    const float *matrices, const float *vectors, float *output, size_t count
+) {
+  size_t i{0};
+#if SOLARIS_SIMD_SSE
+  for (; i < (count & ~size_t{3}); i += 4) {
+    __m128 coordinates[4];
+    for (size_t k{0}; k < 4; ++k)
+      coordinates[k] = _mm_loadu_ps(vectors + 4 * (i + k));
+    _MM_TRANSPOSE4_PS(
+        coordinates[0], coordinates[1], coordinates[2], coordinates[3]
+    );
+
+    __m128 result[4];
+    for (size_t row{0}; row < 4; ++row) {
+      // entry (row, column) of the four matrices in each register
+      __m128 entries[4];
+      for (size_t k{0}; k < 4; ++k)
+        entries[k] = _mm_loadu_ps(matrices + 16 * (i + k) + 4 * row);
+      _MM_TRANSPOSE4_PS(entries[0], entries[1], entries[2], entries[3]);
+
+      result[row] = _mm_mul_ps(entries[0], coordinates[0]);
+      for (size_t column{1}; column < 4; ++column) {
+        result[row] = _mm_add_ps(
+            result[row], _mm_mul_ps(entries[column], coordinates[column])
+        );
+      }
+    }
+    _MM_TRANSPOSE4_PS(result[0], result[1], result[2], result[3]);
+    for (size_t k{0}; k < 4; ++k)
+      _mm_storeu_ps(output + 4 * (i + k), result[k]);
+  }
+#endif
+  for (; i < count; ++i)
+    transform4(matrices + 16 * i, vectors + 4 * i, output + 4 * i);
+}
+
+/**
+ * output[i] = a[i] * b[i] for `count` row-major 4x4 matrices stored back to
+ * back. SSE multiplies four pairs at once, laid out like `transform4Each`.
+ * Every b[i] is read before any output, and each row of a[i] before the
+ * same row of the output, so the output may alias either input.
+ */
+inline void multiply4x4Each(
+    const float *a, const float *b, float *output, size_t count
+) {
+  size_t i{0};
+#if SOLARIS_SIMD_SSE
+  for (; i < (count & ~size_t{3}); i += 4) {
+    __m128 rhs[4][4];
+    for (size_t row{0}; row < 4; ++row) {
+      for (size_t k{0}; k < 4; ++k)
+        rhs[row][k] = _mm_loadu_ps(b + 16 * (i + k) + 4 * row);
+      _MM_TRANSPOSE4_PS(rhs[row][0], rhs[row][1], rhs[row][2], rhs[row][3]);
+    }
+
+    for (size_t row{0}; row < 4; ++row) {
+      __m128 lhs[4];
+      for (size_t k{0}; k < 4; ++k)
+        lhs[k] = _mm_loadu_ps(a + 16 * (i + k) + 4 * row);
+      _MM_TRANSPOSE4_PS(lhs[0], lhs[1], lhs[2], lhs[3]);
+
+      __m128 result[4];
+      for (size_t column{0}; column < 4; ++column) {
+        result[column] = _mm_mul_ps(lhs[0], rhs[0][column]);
+        for (size_t k{1}; k < 4; ++k) {
+          result[column] = _mm_add_ps(
+              result[column], _mm_mul_ps(lhs[k], rhs[k][column])
+          );
+        }
+      }
+      _MM_TRANSPOSE4_PS(result[0], result[1], result[2], result[3]);
+      for (size_t k{0}; k < 4; ++k)
+        _mm_storeu_ps(output + 16 * (i + k) + 4 * row, result[k]);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    float product[16];
+    multiply4x4(a + 16 * i, b + 16 * i, product);
+    for (size_t k{0}; k < 16; ++k)
+      output[16 * i + k] = product[k];
+  }
+}
+
+/**
+ * Transforms `count` points given as separate x, y and z arrays by a
+ * row-major affine 4x4 matrix, several points per instruction. `w` is the
+ * implied fourth coordinate: 1 for points, 0 for directions.
+ */
+inline void transformSoa(
+    const float *m,
+    float w,
+    const float *x,
+    const float *y,
+    const float *z,
+    float *outputX,
+    float *outputY,
+    float *outputZ,
+    size_t count
+) {
+  size_t i{0};
+#if SOLARIS_SIMD_AVX
+  __m256 entries[12];
+  for (size_t k{0}; k < 12; ++k)
+    entries[k] = _mm256_set1_ps(m[k]);
+  auto ws{_mm256_set1_ps(w)};
+
+  for (; i < (count & ~size_t{7}); i += 8) {
+    auto xs{_mm256_loadu_ps(x + i)};
+    auto ys{_mm256_loadu_ps(y + i)};
+    auto zs{_mm256_loadu_ps(z + i)};
+    float *outputs[3]{outputX, outputY, outputZ};
+    for (size_t row{0}; row < 3; ++row) {
+      auto result{_mm256_mul_ps(entries[4 * row], xs)};
+      result = _mm256_add_ps(result, _mm256_mul_ps(entries[4 * row + 1], ys));
+      result = _mm256_add_ps(result, _mm256_mul_ps(entries[4 * row + 2], zs));
+      result = _mm256_add_ps(result, _mm256_mul_ps(entries[4 * row + 3], ws));
+      _mm256_storeu_ps(outputs[row] + i, result);
+    }
+  }
+#elif SOLARIS_SIMD_SSE
+  __m128 entries[12];
+  for (size_t k{0}; k < 12; ++k)
+    entries[k] = _mm_set1_ps(m[k]);
+  auto ws{_mm_set1_ps(w)};
+
+  for (; i < (count & ~size_t{3}); i += 4) {
+    auto xs{_mm_loadu_ps(x + i)};
+    auto ys{_mm_loadu_ps(y + i)};
+    auto zs{_mm_loadu_ps(z + i)};
+    float *outputs[3]{outputX, outputY, outputZ};
+    for (size_t row{0}; row < 3; ++row) {
+      auto result{_mm_mul_ps(entries[4 * row], xs)};
+      result = _mm_add_ps(result, _mm_mul_ps(entries[4 * row + 1], ys));
+      result = _mm_add_ps(result, _mm_mul_ps(entries[4 * row + 2], zs));
+      result = _mm_add_ps(result, _mm_mul_ps(entries[4 * row + 3], ws));
+      _mm_storeu_ps(outputs[row] + i, result);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    auto px{x[i]};
+    auto py{y[i]};
+    auto pz{z[i]};
+    outputX[i] = m[0] * px + m[1] * py + m[2] * pz + m[3] * w;
+    outputY[i] = m[4] * px + m[5] * py + m[6] * pz + m[7] * w;
+    outputZ[i] = m[8] * px + m[9] * py + m[10] * pz + m[11] * w;
+  }
+}
+
+inline float dot3(const float *a, const float *b) {
+#if SOLARIS_SIMD_SSE
+  auto product{_mm_mul_ps(impl::load3(a), impl::load3(b))};
+  return _mm_cvtss_f32(impl::horizontalSum(product));
+#else
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+#endif
+}
+
+inline float dot4(const float *a, const float *b) {
+#if SOLARIS_SIMD_SSE
+  auto product{_mm_mul_ps(_mm_loadu_ps(a), _mm_loadu_ps(b))};
+  return _mm_cvtss_f32(impl::horizontalSum(product));
+#else
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+#endif
+}
+
+namespace impl {
+/**
+ * Coefficients of the polynomial slerp estimate from D. Eberly, "A Fast and
+ * Accurate Algorithm for Computing SLERP": slerp = d(t) from + c(t) to, with
+ * no trigonometry, so it vectorizes. The weights are within 3e-5 of the
+ * exact ones for unit quaternions.
+ */
+inline constexpr float SlerpMu{1.90110745351730037f};
+inline constexpr float SlerpU[8]{
+    1.0f / (1 * 3),
+    1.0f / (2 * 5),
+    1.0f / (3 * 7),
+    1.0f / (4 * 9),
+    1.0f / (5 * 11),
+    1.0f / (6 * 13),
+    1.0f / (7 * 15),
+    SlerpMu / (8 * 17),
+};
+inline constexpr float SlerpV[8]{
+    1.0f / 3,
+    2.0f / 5,
+    3.0f / 7,
+    4.0f / 9,
+    5.0f / 11,
+    6.0f / 13,
+    7.0f / 15,
+    SlerpMu * 8 / 17,
+};
+
+/** sin(t θ) / sin θ, given cos θ - 1 with θ in [0, π/2]. */
+inline float slerpWeight(float cosineMinusOne, float t) {
+  auto squared{t * t};
+  float weight{1};
+  for (size_t i{8}; i-- > 0;)
+    weight = 1 + (SlerpU[i] * squared - SlerpV[i]) * cosineMinusOne * weight;
+  return t * weight;
+}
+
+#if SOLARIS_SIMD_SSE
+inline __m128 slerpWeight(__m128 cosineMinusOne, __m128 t) {
+  auto squared{_mm_mul_ps(t, t)};
+  auto weight{_mm_set1_ps(1)};
+  for (size_t i{8}; i-- > 0;) {
+    auto term{_mm_sub_ps(
+        _mm_mul_ps(_mm_set1_ps(SlerpU[i]), squared), _mm_set1_ps(SlerpV[i])
+    )};
+    weight = _mm_add_ps(
+        _mm_set1_ps(1), _mm_mul_ps(_mm_mul_ps(term, cosineMinusOne), weight)
+    );
+  }
+  return _mm_mul_ps(t, weight);
+}
+#endif
+} // namespace impl
+
+/**
+ * output[i] = slerp(from[i], to[i], t[i * tStride]) for `count` unit
+ * quaternions stored as (x, y, z, w), along the shorter arc. A `tStride` of
+ * 0 uses the same t for every quaternion. SSE handles four per iteration.
+ */
+inline void slerpBatch(
+    const float *from,
+    const float *to,
+    const float *t,
+    size_t tStride,
+    float *output,
+    size_t count
+) {
+  size_t i{0};
+#if SOLARIS_SIMD_SSE
+  auto one{_mm_set1_ps(1)};
+  auto signMask{_mm_set1_ps(-0.0f)};
+  for (; i < (count & ~size_t{3}); i += 4) {
+    __m128 a[4];
+    __m128 b[4];
+    for (size_t k{0}; k < 4; ++k) {
+      a[k] = _mm_loadu_ps(from + 4 * (i + k));
+      b[k] = _mm_loadu_ps(to + 4 * (i + k));
+    }
+    // one component of four quaternions per register
+    _MM_TRANSPOSE4_PS(a[0], a[1], a[2], a[3]);
+    _MM_TRANSPOSE4_PS(b[0], b[1], b[2], b[3]);
+
+    auto cosine{_mm_mul_ps(a[0], b[0])};
+    for (size_t k{1}; k < 4; ++k)
+      cosine = _mm_add_ps(cosine, _mm_mul_ps(a[k], b[k]));
+    auto sign{_mm_and_ps(cosine, signMask)};
+    auto cosineMinusOne{_mm_sub_ps(_mm_xor_ps(cosine, sign), one)};
+
+    auto times{tStride == 0 ? _mm_set1_ps(*t) : _mm_loadu_ps(t + i)};
+    auto toWeight{
+        _mm_xor_ps(impl::slerpWeight(cosineMinusOne, times), sign)
+    };
+    auto fromWeight{
+        impl::slerpWeight(cosineMinusOne, _mm_sub_ps(one, times))
+    };
+
+    __m128 result[4];
+    for (size_t k{0}; k < 4; ++k) {
+      result[k] = _mm_add_ps(
+          _mm_mul_ps(fromWeight, a[k]), _mm_mul_ps(toWeight, b[k])
+      );
+    }
+    _MM_TRANSPOSE4_PS(result[0], result[1], result[2], result[3]);
+    for (size_t k{0}; k < 4; ++k)
+      _mm_storeu_ps(output + 4 * (i + k), result[k]);
+  }
+#endif
+  for (; i < count; ++i) {
+    auto a{from + 4 * i};
+    auto b{to + 4 * i};
+    auto time{t[i * tStride]};
+    auto cosine{dot4(a, b)};
+    auto sign{cosine < 0 ? -1.0f : 1.0f};
+    auto cosineMinusOne{cosine * sign - 1};
+    auto toWeight{impl::slerpWeight(cosineMinusOne, time) * sign};
+    auto fromWeight{impl::slerpWeight(cosineMinusOne, 1 - time)};
+    float result[4];
+    for (size_t k{0}; k < 4; ++k)
+      result[k] = fromWeight * a[k] + toWeight * b[k];
+    for (size_t k{0}; k < 4; ++k)
+      output[4 * i + k] = result[k];
+  }
+}
+
+inline void cross3(const float *a, const float *b, float *output) {
+#if SOLARIS_SIMD_SSE
+  auto lhs{impl::load3(a)};
+  auto rhs{impl::load3(b)};
+  // (a.yzx * b.zxy) - (a.zxy * b.yzx)
+  auto lhsYZX{_mm_shuffle_ps(lhs, lhs, _MM_SHUFFLE(3, 0, 2, 1))};
+  auto rhsYZX{_mm_shuffle_ps(rhs, rhs, _MM_SHUFFLE(3, 0, 2, 1))};
+  auto crossed{_mm_sub_ps(_mm_mul_ps(lhs, rhsYZX), _mm_mul_ps(lhsYZX, rhs))};
+  impl::store3(
+      output, _mm_shuffle_ps(crossed, crossed, _MM_SHUFFLE(3, 0, 2, 1))
+  );
+#else
+  float result[3]{
+      a[1] * b[2] - a[2] * b[1],
+      a[2] * b[0] - a[0] * b[2],
+      a[0] * b[1] - a[1] * b[0],
+  };
+  for (size_t i{0}; i < 3; ++i)
+    output[i] = result[i];
+#endif
+}
+
+/** Scales a 3- or 4-vector to unit length. */
+template <size_t D>
+  requires(D == 3 || D == 4)
+void normalize(const float *v, float *output) {
+#if SOLARIS_SIMD_SSE
+  __m128 value;
+  if constexpr (D == 3)
+    value = impl::load3(v);
+  else
+    value = _mm_loadu_ps(v);
+  auto length{_mm_sqrt_ps(impl::horizontalSum(_mm_mul_ps(value, value)))};
+  auto result{_mm_div_ps(value, length)};
+  if constexpr (D == 3)
+    impl::store3(output, result);
+  else
+    _mm_storeu_ps(output, result);
+#else
+  auto length{std::sqrt(D == 3 ? dot3(v, v) : dot4(v, v))};
+  for (size_t i{0}; i < D; ++i)
+    output[i] = v[i] / length;
+#endif
+}
+} // namespace solaris::simd
@@ -0,0 +1,327 @@
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <memory>
+#include <solaris/core/bus.hpp>
+#include <solaris/core/delegate.hpp>
+#include <solaris/core/layer.hpp>
+#include <solaris/core/layer_stack.hpp>
+#include <solaris/core/static_bus.hpp>
+#include <solaris/core/thread_pool.hpp>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using solaris::core::Bus;
+using solaris::core::Delegate;
+using solaris::core::Dispatcher;
+using solaris::core::Layer;
+using solaris::core::LayerStack;
+using solaris::core::StaticBus;
+
+namespace {
+struct Trace {
+  std::vector<std::string> Entries;
+};
+
+struct Ping {};
+struct Pong {};
+
+class OuterLayer : public Layer<OuterLayer, Trace> {
+public:
+  void setup(Handlers handlers) override {
+    handlers.addInstanceHandler<Ping>(&OuterLayer::onPing);
+    handlers.addStaticHandler<Pong>(&OuterLayer::onPong);
+  }
+
+  void onPing(Context<Ping> context) {
+    context->Entries.push_back("outer ping");
+    context.next();
+    context->Entries.push_back("outer ping after");
+  }
+
+  static void onPong(Context<Pong> context) {
+    context->Entries.push_back("outer pong");
+    context.next();
+  }
+};
+
+class InnerLayer : public Layer<InnerLayer, Trace> {
+public:
+  void setup(Handlers handlers) override {
+    handlers.addInstanceHandler<Ping, &InnerLayer::onPing>();
+  }
+
+  void onPing(Context<Ping> context) {
+    context->Entries.push_back("inner ping");
+    context.next();
+  }
+};
+
+LayerStack<Trace> layerStack() {
+  LayerStack<Trace> layers{};
+  layers.addLayer<OuterLayer>();
+  layers.addLayer<InnerLayer>();
+  return layers;
+}
+} // namespace
+
+TEST_CASE("Bus dispatches through layers in order", "[core][Bus]") {
+  auto layers{layerStack()};
+  auto bus{layers.compileBus()};
+
+  Trace trace{};
+  bus.dispatch(Ping{}, trace);
+  bus.dispatch(Pong{}, trace);
+
+  REQUIRE(
+      trace.Entries == std::vector<std::string>{
+                           "outer ping",
+                           "inner ping",
+                           "outer ping after",
+                           "outer pong",
+                       }
+  );
+}
+
+TEST_CASE("StaticBus compiled from the same layers", "[core][StaticBus]") {
+  auto layers{layerStack()};
+  auto bus{layers.compileBus<StaticBus<Trace, Ping, Pong>>()};
+
+  STATIC_REQUIRE(decltype(bus)::Carries<Ping>);
+  STATIC_REQUIRE_FALSE(decltype(bus)::Carries<int>);
+  REQUIRE(bus.findDispatcher<int>() == nullptr);
+
+  Trace trace{};
+  bus.dispatch(Ping{}, trace);
+  bus.dispatch(Pong{}, trace);
+
+  REQUIRE(
+      trace.Entries == std::vector<std::string>{
+                           "outer ping",
+                           "inner ping",
+                           "outer ping after",
+                           "outer pong",
+                       }
+  );
+}
+
+TEST_CASE(
+    "StaticBus rejects handlers of events it doesn't carry",
+    "[core][StaticBus]"
+) {
+  using PingOnly = StaticBus<Trace, Ping>;
+  auto layers{layerStack()};
+  REQUIRE_THROWS_AS(layers.compileBus<PingOnly>(), std::invalid_argument);
+}
+
+TEST_CASE("Delegate stores callables inline", "[core][Delegate]") {
+  struct Accumulator {
+    int Total{0};
+
+    void add(int value) { Total += value; }
+  };
+
+  Accumulator accumulator{};
+  int calls{0};
+
+  std::vector<Delegate<void(int)>> delegates{};
+  delegates.emplace_back(accumulator, &Accumulator::add);
+  delegates.push_back(
+      Delegate<void(int)>::bind<&Accumulator::add>(accumulator)
+  );
+  delegates.emplace_back([&calls](int) { ++calls; });
+  delegates.emplace_back(+[](int) {});
+
+  for (auto &delegate : delegates)
+    delegate(3);
+
+  REQUIRE(accumulator.Total == 6);
+  REQUIRE(calls == 1);
+  REQUIRE_FALSE(Delegate<void(int)>{});
+}
+
+TEST_CASE(
+    "Delegate owns callables that do not fit inline",
+    "[core][Delegate]"
+) {
+  auto owner{std::make_shared<std::string>("shared")};
+  std::string suffix(64, '!');
+  std::vector<std::string> calls;
+
+  {
+    Delegate<void(int)> delegate{[owner, suffix, &calls](int value) {
+      calls.push_back(*owner + std::to_string(value) + suffix.substr(62));
+    }};
+    REQUIRE(owner.use_count() == 2);
+
+    auto copy{delegate};
+    REQUIRE(owner.use_count() == 3);
+    std::vector<Delegate<void(int)>> moved{};
+    moved.push_back(std::move(delegate));
+    REQUIRE(owner.use_count() == 3);
+    REQUIRE_FALSE(delegate);
+
+    copy = moved.front();
+    copy(1);
+    moved.front()(2);
+  }
+  REQUIRE(owner.use_count() == 1);
+  REQUIRE(calls == std::vector<std::string>{"shared1!!", "shared2!!"});
+
+  Bus<Trace> bus{};
+  bus.addHandler<Ping>([owner](Dispatcher<Ping, Trace>::Context context) {
+    context->Entries.push_back(*owner);
+  });
+  Trace trace{};
+  bus.dispatch(Ping{}, trace);
+  REQUIRE(trace.Entries == std::vector<std::string>{"shared"});
+}
+
+TEST_CASE("Pass-through handlers run in a flat loop", "[core][Dispatcher]") {
+  using solaris::core::Dispatcher;
+  using solaris::core::HandlerMode;
+  using PingContext = Dispatcher<Ping, Trace>::Context;
+
+  Dispatcher<Ping, Trace> dispatcher{};
+  dispatcher.addHandler(
+      [](PingContext context) {
+        context->Entries.push_back("first");
+        context.next();
+      },
+      HandlerMode::Passthrough
+  );
+  dispatcher.addHandler([](PingContext context) {
+    context->Entries.push_back("around");
+    context.next();
+    context->Entries.push_back("around after");
+  });
+  dispatcher.addHandler(
+      [](PingContext context) {
+        context->Entries.push_back("second");
+        context.next();
+      },
+      HandlerMode::Passthrough
+  );
+  dispatcher.addHandler(
+      [](PingContext context) { context->Entries.push_back("consumer"); },
+      HandlerMode::Passthrough
+  );
+  dispatcher.addHandler(
+      [](PingContext context) { context->Entries.push_back("unreachable"); },
+      HandlerMode::Passthrough
+  );
+
+  Trace trace{};
+  dispatcher.dispatch(Ping{}, trace);
+
+  REQUIRE(
+      trace.Entries == std::vector<std::string>{
+                           "first",
+                           "around",
+                           "second",
+                           "consumer",
+                           "around after",
+                       }
+  );
+}
+
+TEST_CASE("Observers fan out between ordered handlers", "[core][Dispatcher]") {
+  using solaris::core::HandlerMode;
+  using solaris::core::ThreadPool;
+
+  struct Tally {
+    std::atomic<int> Observed{0};
+    std::atomic<int> Overlapping{0};
+    std::vector<std::string> Ordered;
+  };
+  using Context = solaris::core::Dispatcher<Ping, Tally>::Context;
+
+  constexpr int observers{3};
+  Bus<Tally> bus{};
+  bus.addHandler<Ping>([](Context context) {
+    context->Ordered.push_back("before " + std::to_string(context->Observed));
+    context.next();
+    context->Ordered.push_back("after " + std::to_string(context->Observed));
+  });
+  for (int i{0}; i < observers; ++i) {
+    bus.addHandler<Ping>(
+        [](Context context) {
+          ++context->Observed;
+          // every observer waits to see the others running at the same time
+          auto deadline{
+              std::chrono::steady_clock::now() + std::chrono::seconds{5}
+          };
+          while (context->Observed < observers &&
+                 std::chrono::steady_clock::now() < deadline)
+            std::this_thread::yield();
+          if (context->Observed == observers)
+            ++context->Overlapping;
+          context.next();
+        },
+        HandlerMode::Observer
+    );
+  }
+  bus.addHandler<Ping>(
+      [](Context context) {
+        context->Ordered.push_back("last " + std::to_string(context->Observed));
+      },
+      HandlerMode::Passthrough
+  );
+
+  ThreadPool pool{observers};
+  bus.setObserverPool(&pool);
+
+  Tally tally{};
+  bus.dispatch(Ping{}, tally);
+
+  REQUIRE(tally.Overlapping == observers);
+  REQUIRE(
+      tally.Ordered == std::vector<std::string>{"before 0", "last 3", "after 3"}
+  );
+}
+
+TEST_CASE(
+    "Batch handlers only see events that reach them",
+    "[core][Dispatcher]"
+) {
+  struct Key {
+    int Value;
+  };
+  using KeyDispatcher = Dispatcher<Key, Trace>;
+
+  KeyDispatcher dispatcher{};
+  auto record{[](std::string name) {
+    return [name](KeyDispatcher::Batch batch) {
+      auto entry{name};
+      for (const auto &event : batch)
+        entry += std::to_string(event.Value);
+      batch->Entries.push_back(entry);
+    };
+  }};
+  dispatcher.addBatchHandler(record("top "));
+  // a layer that consumes odd keys, hiding them from the layers below
+  dispatcher.addHandler([](KeyDispatcher::Context context) {
+    if (context.event().Value % 2 == 0)
+      context.next();
+  });
+  dispatcher.addBatchHandler(record("below "));
+
+  Trace trace{};
+  std::vector<Key> keys{{0}, {2}, {3}, {4}};
+  dispatcher.dispatchBatch(keys, trace);
+  dispatcher.dispatch(Key{5}, trace);
+  dispatcher.dispatch(Key{6}, trace);
+
+  REQUIRE(
+      trace.Entries == std::vector<std::string>{
+                           "top 0234",
+                           "below 02",
+                           "below 4",
+                           "top 5",
+                           "top 6",
+                           "below 6",
+                       }
+  );
+}
@@ -1,5 +1,11 @@
+#include <algorithm>
 #include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <functional>
+#include <solaris/core/static_bus.hpp>
 #include <solaris/framework/ecs.hpp>
+#include <span>
+#include <stdexcept>
 #include <unordered_set>
 
 #include "test_components.hpp"
@@ -31,11 +37,18 @@ TEST_CASE("World view entities", "[ecs][World]") {
   std::unordered_set<Entity> entitiesAB;
   std::unordered_set<Entity> entitiesABC;
   std::unordered_set<Entity> entitiesAC;
+  // storage moves and destroys components, so strings must be constructed
+  auto create{[&](const RuntimeStruct &shape, bool withString) {
+    auto [entity, object]{world.createEntity(shape)};
+    if (withString)
+      object.select<ComponentC>()->emplaceField<ComponentC>();
+    return entity;
+  }};
   for (size_t i{0}; i < 10; ++i) {
-    entitiesA.insert(world.createEntity(shapeA).first);
-    entitiesAB.insert(world.createEntity(shapeAB).first);
-    entitiesABC.insert(world.createEntity(shapeABC).first);
-    entitiesAC.insert(world.createEntity(shapeAC).first);
+    entitiesA.insert(create(shapeA, false));
+    entitiesAB.insert(create(shapeAB, false));
+    entitiesABC.insert(create(shapeABC, true));
+    entitiesAC.insert(create(shapeAC, true));
   }
 
   auto view{World::View::withComponents<ComponentA, ComponentB>()};
@@ -60,3 +73,433 @@ TEST_CASE("World view entities", "[ecs][World]") {
     return queryEntities.contains(entity);
   }));
 }
+
+TEST_CASE("World view with query terms", "[ecs][World]") {
+  using solaris::AnyOf;
+  using solaris::Optional;
+  using solaris::Without;
+
+  World world{};
+  auto shapeA{RuntimeStruct().withMember<ComponentA>()};
+  auto shapeAB{shapeA.withMember<ComponentB>()};
+  auto shapeAC{shapeA.withMember<ComponentC>()};
+  auto shapeB{RuntimeStruct().withMember<ComponentB>()};
+
+  // the world destroys every component, so strings must be constructed
+  auto create{[&](const RuntimeStruct &shape, int value, bool withString) {
+    auto [entity, object]{world.createEntity(shape)};
+    if (value != 0)
+      object.select<ComponentA>()->emplaceField<ComponentA>(value);
+    if (withString)
+      object.select<ComponentC>()->emplaceField<ComponentC>();
+    return entity;
+  }};
+  auto a{create(shapeA, 1, false)};
+  auto ab{create(shapeAB, 2, false)};
+  auto ac{create(shapeAC, 3, true)};
+  auto b{create(shapeB, 0, false)};
+
+  auto collect{[&](const auto &view) {
+    std::unordered_set<Entity> entities;
+    for (auto [entity, _] : world.query(view))
+      entities.insert(entity);
+    return entities;
+  }};
+
+  REQUIRE(
+      collect(World::View::withComponents<ComponentA, Without<ComponentB>>()) ==
+      std::unordered_set<Entity>{a, ac}
+  );
+  REQUIRE(
+      collect(World::View::withComponents<AnyOf<ComponentB, ComponentC>>()) ==
+      std::unordered_set<Entity>{ab, ac, b}
+  );
+  REQUIRE(
+      collect(World::View::withComponents<
+              ComponentA,
+              Without<ComponentC>,
+              AnyOf<ComponentB, ComponentC>>()) ==
+      std::unordered_set<Entity>{ab}
+  );
+
+  size_t withB{0};
+  auto view{World::View::withComponents<ComponentA, Optional<ComponentB>>()};
+  for (auto [entity, components] : world.query(view)) {
+    auto *optional{components.tryGetField<ComponentB>()};
+    REQUIRE((optional != nullptr) == (entity == ab));
+    REQUIRE(components.getField<ComponentA>().value != 0);
+    withB += optional != nullptr;
+  }
+  REQUIRE(withB == 1);
+}
+
+TEST_CASE("World add and remove components", "[ecs][World]") {
+  World world{};
+  auto [entity, object]{
+      world.createEntity(RuntimeStruct().withMember<ComponentA>())
+  };
+  object.select<ComponentA>()->emplaceField<ComponentA>(7);
+
+  REQUIRE(world.get<ComponentC>(entity) == nullptr);
+  world.add<ComponentC>(entity, "added");
+  REQUIRE(world.get<ComponentA>(entity)->value == 7);
+  REQUIRE(world.get<ComponentC>(entity)->value == "added");
+
+  world.add<ComponentA>(entity, 8);
+  REQUIRE(world.get<ComponentA>(entity)->value == 8);
+
+  world.remove<ComponentA>(entity);
+  REQUIRE(world.get<ComponentA>(entity) == nullptr);
+  REQUIRE(world.get<ComponentC>(entity)->value == "added");
+}
+
+TEST_CASE("World relations", "[ecs][World]") {
+  struct OwnedBy {};
+  struct Targets {};
+
+  World world{};
+  auto shape{RuntimeStruct().withMember<ComponentC>()};
+  auto create{[&] {
+    auto [entity, object]{world.createEntity(shape)};
+    object.select<ComponentC>()->emplaceField<ComponentC>("alive");
+    return entity;
+  }};
+  auto player{create()};
+  auto sword{create()};
+  auto shield{create()};
+  auto enemy{create()};
+
+  REQUIRE(world.relate<OwnedBy>(sword, player));
+  REQUIRE(world.relate<OwnedBy>(shield, player));
+  REQUIRE_FALSE(world.relate<OwnedBy>(sword, player));
+  REQUIRE(world.relate<Targets>(enemy, player));
+  REQUIRE(world.relate<Targets>(player, enemy));
+
+  REQUIRE(
+      std::ranges::equal(
+          world.sources<OwnedBy>(player), std::vector<Entity>{sword, shield}
+      )
+  );
+  REQUIRE(world.hasRelation<OwnedBy>(sword, player));
+  REQUIRE_FALSE(world.hasRelation<OwnedBy>(player, sword));
+  REQUIRE(world.sources<OwnedBy>(enemy).empty());
+
+  SECTION("pairs can be removed") {
+    REQUIRE(world.unrelate<OwnedBy>(sword, player));
+    REQUIRE_FALSE(world.unrelate<OwnedBy>(sword, player));
+    REQUIRE(
+        std::ranges::equal(
+            world.sources<OwnedBy>(player), std::vector<Entity>{shield}
+        )
+    );
+    REQUIRE(world.targets<OwnedBy>(sword).empty());
+  }
+
+  SECTION("destroying a target removes its pairs") {
+    REQUIRE(world.destroyEntity(player));
+    REQUIRE_FALSE(world.destroyEntity(player));
+    REQUIRE_FALSE(world.contains(player));
+    REQUIRE(world.targets<OwnedBy>(sword).empty());
+    REQUIRE(world.targets<OwnedBy>(shield).empty());
+    REQUIRE(world.targets<Targets>(enemy).empty());
+    REQUIRE(world.sources<Targets>(enemy).empty());
+
+    // the entity moved into the freed row is still found
+    REQUIRE(world.get<ComponentC>(enemy)->value == "alive");
+    REQUIRE_THROWS_AS(
+        world.relate<OwnedBy>(sword, player), std::out_of_range
+    );
+  }
+}
+
+TEST_CASE("World shared components", "[ecs][World]") {
+  using solaris::Shared;
+
+  struct Mesh {
+    int Id;
+    bool operator==(const Mesh &) const = default;
+  };
+
+  World world{};
+  auto shape{RuntimeStruct().withMember<ComponentA>()};
+  std::vector<Entity> entities;
+  for (int i{0}; i < 6; ++i) {
+    auto [entity, object]{world.createEntity(shape)};
+    object.select<ComponentA>()->emplaceField<ComponentA>(i);
+    world.setShared(entity, Mesh{i % 2});
+    entities.push_back(entity);
+  }
+
+  REQUIRE(world.getShared<Mesh>(entities[2])->Id == 0);
+  REQUIRE(world.getShared<Mesh>(entities[3])->Id == 1);
+  REQUIRE(world.get<ComponentA>(entities[3])->value == 3);
+  // equal values are stored once, by the archetype
+  REQUIRE(
+      world.getShared<Mesh>(entities[0]) == world.getShared<Mesh>(entities[4])
+  );
+
+  // entities sharing a value are visited together
+  std::vector<int> meshes;
+  auto view{World::View::withComponents<ComponentA, Shared<Mesh>>()};
+  for (auto [entity, components] : world.query(view)) {
+    auto id{components.getShared<Mesh>().Id};
+    REQUIRE(id == components.getField<ComponentA>().value % 2);
+    meshes.push_back(id);
+  }
+  REQUIRE(meshes.size() == 6);
+  REQUIRE(std::ranges::is_partitioned(meshes, [&](int id) {
+    return id == meshes.front();
+  }));
+
+  world.setShared(entities[0], Mesh{1});
+  REQUIRE(
+      world.getShared<Mesh>(entities[0]) == world.getShared<Mesh>(entities[1])
+  );
+  world.removeShared<Mesh>(entities[0]);
+  REQUIRE(world.getShared<Mesh>(entities[0]) == nullptr);
+  REQUIRE(world.get<ComponentA>(entities[0])->value == 0);
+}
+
+TEST_CASE("World singletons", "[ecs][World]") {
+  World world{};
+  REQUIRE(world.singleton<ComponentC>() == nullptr);
+
+  world.setSingleton<ComponentC>("camera");
+  REQUIRE(world.singleton<ComponentC>()->value == "camera");
+  world.setSingleton<ComponentC>("other");
+  REQUIRE(world.singleton<ComponentC>()->value == "other");
+
+  world.removeSingleton<ComponentC>();
+  REQUIRE(world.singleton<ComponentC>() == nullptr);
+}
+
+TEST_CASE("World value indexes", "[ecs][World]") {
+  struct Team {
+    int Number;
+  };
+
+  World world{};
+  auto first{world.createEntityWith(Team{1}, ComponentA{10})};
+  auto &byTeam{world.addIndex<Team>([](const Team &team) {
+    return team.Number;
+  })};
+  auto second{world.createEntityWith(Team{1})};
+  auto third{world.createEntityWith(Team{3}, ComponentC{"name"})};
+
+  auto sorted{[](std::span<const Entity> entities) {
+    std::vector<Entity> output(entities.begin(), entities.end());
+    std::ranges::sort(output);
+    return output;
+  }};
+  REQUIRE(sorted(byTeam.find(1)) == std::vector<Entity>{first, second});
+  REQUIRE(byTeam.findOne(3) == third);
+  REQUIRE(byTeam.count(2) == 0);
+
+  world.modify<Team>(first, [](Team &team) { team.Number = 3; });
+  REQUIRE(sorted(byTeam.find(1)) == std::vector<Entity>{second});
+  REQUIRE(sorted(byTeam.find(3)) == std::vector<Entity>{first, third});
+
+  world.add<Team>(second, 2);
+  REQUIRE(byTeam.count(1) == 0);
+  REQUIRE(byTeam.findOne(2) == second);
+
+  world.get<Team>(second)->Number = 4;
+  world.reindex<Team>(second);
+  REQUIRE(byTeam.findOne(4) == second);
+
+  world.destroyEntity(third);
+  world.remove<Team>(second);
+  REQUIRE(sorted(byTeam.find(3)) == std::vector<Entity>{first});
+  REQUIRE(byTeam.count(4) == 0);
+}
+
+TEST_CASE("World observers", "[ecs][World]") {
+  using solaris::ComponentAdded;
+  using solaris::ComponentRemoved;
+  using solaris::ComponentSet;
+  using solaris::core::Bus;
+  using solaris::core::Dispatcher;
+
+  struct Log {
+    World *Source{nullptr};
+    std::vector<std::vector<Entity>> Added{};
+    std::vector<Entity> Set{};
+    std::vector<Entity> Removed{};
+  };
+
+  Bus<Log> bus{};
+  bus.addBatchHandler<ComponentAdded<ComponentA>>(
+      [](Dispatcher<ComponentAdded<ComponentA>, Log>::Batch batch) {
+        auto &added{batch->Added.emplace_back()};
+        for (const auto &event : batch) {
+          added.push_back(event.EntityID);
+          // changes made by handlers are delivered by the next flush
+          if (batch->Source->contains(event.EntityID))
+            batch->Source->add<ComponentA>(event.EntityID, 0);
+        }
+      }
+  );
+  bus.addHandler<ComponentSet<ComponentA>>(
+      [](Dispatcher<ComponentSet<ComponentA>, Log>::Context c) {
+        c->Set.push_back(c.event().EntityID);
+      }
+  );
+  bus.addHandler<ComponentRemoved<ComponentA>>(
+      [](Dispatcher<ComponentRemoved<ComponentA>, Log>::Context c) {
+        c->Removed.push_back(c.event().EntityID);
+      }
+  );
+
+  World world{};
+  world.observe<ComponentA>(bus);
+  Log log{.Source = &world};
+
+  auto first{world.createEntityWith(ComponentA{1})};
+  auto second{world.createEntityWith(ComponentC{"no A yet"})};
+  world.add<ComponentA>(second, 2);
+  world.modify<ComponentA>(first, [](ComponentA &a) { a.value = 3; });
+  auto third{world.createEntityWith(ComponentA{4})};
+  world.destroyEntity(third);
+  REQUIRE(log.Added.empty());
+
+  world.flushEvents(log);
+  REQUIRE(
+      log.Added == std::vector<std::vector<Entity>>{{first, second, third}}
+  );
+  REQUIRE(log.Set == std::vector<Entity>{first});
+  REQUIRE(log.Removed == std::vector<Entity>{third});
+
+  world.remove<ComponentA>(second);
+  world.flushEvents(log);
+  REQUIRE(log.Added.size() == 1);
+  // the handler's add replaced the A of every entity still alive
+  REQUIRE(log.Set == std::vector<Entity>{first, first, second});
+  REQUIRE(log.Removed == std::vector<Entity>{third, second});
+
+  // any bus flavor can observe, such as a StaticBus over the three events
+  solaris::core::StaticBus<
+      Log,
+      ComponentAdded<ComponentB>,
+      ComponentSet<ComponentB>,
+      ComponentRemoved<ComponentB>>
+      fixed{};
+  fixed.addHandler<ComponentRemoved<ComponentB>>(
+      [](Dispatcher<ComponentRemoved<ComponentB>, Log>::Context c) {
+        c->Removed.push_back(c.event().EntityID);
+      }
+  );
+  world.observe<ComponentB>(fixed);
+  auto withB{world.createEntityWith(ComponentB{1})};
+  world.destroyEntity(withB);
+  world.flushEvents(log);
+  REQUIRE(log.Removed == std::vector<Entity>{third, second, withB});
+}
+
+TEST_CASE("World compaction", "[ecs][World]") {
+  World world{};
+  std::vector<Entity> kept;
+  std::vector<Entity> dropped;
+  for (int i{0}; i < 100; ++i) {
+    kept.push_back(world.createEntityWith(ComponentA{i}));
+    dropped.push_back(world.createEntityWith(ComponentA{i}, ComponentB{1}));
+    if (i % 10 != 0)
+      dropped.push_back(world.createEntityWith(ComponentC{"temporary"}));
+  }
+  for (auto entity : dropped)
+    world.destroyEntity(entity);
+  for (size_t i{10}; i < kept.size(); ++i)
+    world.destroyEntity(kept[i]);
+  kept.resize(10);
+  auto moved{world.createEntityWith(ComponentC{"moved"})};
+
+  REQUIRE(world.archetypes().size() == 3);
+  auto version{world.archetypeVersion()};
+
+  // a zero budget still makes progress, one archetype at a time
+  size_t calls{1};
+  while (!world.compact(std::chrono::nanoseconds{0}))
+    ++calls;
+  REQUIRE(calls <= 4);
+
+  REQUIRE(world.archetypes().size() == 2);
+  REQUIRE(world.archetypeVersion() != version);
+  for (const auto &archetype : world.archetypes())
+    REQUIRE(archetype.storage().capacity() == archetype.size());
+  for (size_t i{0}; i < kept.size(); ++i)
+    REQUIRE(world.get<ComponentA>(kept[i])->value == static_cast<int>(i));
+  REQUIRE(world.get<ComponentC>(moved)->value == "moved");
+
+  SECTION("rows can be reordered by a key") {
+    auto descending{[](const ComponentA &a, const ComponentA &b) {
+      return a.value > b.value;
+    }};
+    while (!world.compact<ComponentA>(std::chrono::milliseconds{1}, descending))
+      ;
+    std::vector<int> values;
+    for (auto [_, components] :
+         world.query(World::View::withComponents<ComponentA>()))
+      values.push_back(components.getField<ComponentA>().value);
+    REQUIRE(std::ranges::is_sorted(values, std::ranges::greater{}));
+    REQUIRE(world.get<ComponentA>(kept[3])->value == 3);
+  }
+}
+
+TEST_CASE("World sort policies", "[ecs][World]") {
+  World world{};
+  std::vector<Entity> alone;
+  std::vector<Entity> paired;
+  for (int i{0}; i < 50; ++i) {
+    alone.push_back(world.createEntityWith(ComponentA{(i * 7) % 50}));
+    paired.push_back(world.createEntityWith(ComponentA{i}, ComponentB{1}));
+  }
+
+  auto valuesOf{[&](const auto &view) {
+    std::vector<int> values;
+    for (auto [_, components] : world.query(view))
+      values.push_back(components.template getField<ComponentA>().value);
+    return values;
+  }};
+  auto aloneView{
+      World::View::withComponents<ComponentA, solaris::Without<ComponentB>>()
+  };
+  auto pairedView{World::View::withComponents<ComponentA, ComponentB>()};
+
+  world.sortBy<ComponentA>([](const ComponentA &a, const ComponentA &b) {
+    return a.value > b.value;
+  });
+  REQUIRE(std::ranges::is_sorted(valuesOf(aloneView), std::greater<>{}));
+  REQUIRE(std::ranges::is_sorted(valuesOf(pairedView), std::greater<>{}));
+
+  // setting the policy again replaces the order
+  world.sortBy<ComponentA>([](const ComponentA &a, const ComponentA &b) {
+    return a.value < b.value;
+  });
+  REQUIRE(std::ranges::is_sorted(valuesOf(aloneView)));
+  REQUIRE(std::ranges::is_sorted(valuesOf(pairedView)));
+
+  world.modify<ComponentA>(alone[3], [](ComponentA &a) { a.value = -1; });
+  world.modify<ComponentA>(paired[40], [](ComponentA &a) { a.value = 7; });
+  auto created{world.createEntityWith(ComponentA{25})};
+  world.maintainOrder();
+
+  auto values{valuesOf(aloneView)};
+  REQUIRE(std::ranges::is_sorted(values));
+  REQUIRE(values.front() == -1);
+  REQUIRE(std::ranges::is_sorted(valuesOf(pairedView)));
+  REQUIRE(world.get<ComponentA>(alone[3])->value == -1);
+  REQUIRE(world.get<ComponentA>(paired[40])->value == 7);
+  REQUIRE(world.get<ComponentA>(created)->value == 25);
+  for (int i{0}; i < 50; ++i) {
+    if (i != 3)
+      REQUIRE(world.get<ComponentA>(alone[i])->value == (i * 7) % 50);
+    if (i != 40)
+      REQUIRE(world.get<ComponentA>(paired[i])->value == i);
+  }
+
+  SECTION("removed policies no longer apply") {
+    world.removeSortPolicy<ComponentA>();
+    world.modify<ComponentA>(alone[0], [](ComponentA &a) { a.value = 99; });
+    world.maintainOrder();
+    REQUIRE(!std::ranges::is_sorted(valuesOf(aloneView)));
+  }
+}
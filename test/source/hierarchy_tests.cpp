@@ -0,0 +1,119 @@
+#include <catch2/catch_test_macros.hpp>
+#include <solaris/framework/hierarchy.hpp>
+#include <stdexcept>
+#include <vector>
+
+#include "test_components.hpp"
+
+using solaris::Entity;
+using solaris::Hierarchy;
+using solaris::LocalTransform;
+using solaris::Matrix4f;
+using solaris::RuntimeStruct;
+using solaris::Vec3f;
+using solaris::World;
+using solaris::WorldTransform;
+
+namespace {
+Entity createNode(World &world, const RuntimeStruct &shape, Vec3f offset) {
+  auto [entity, object]{world.createEntity(shape)};
+  object.select<LocalTransform>()->emplaceField<LocalTransform>(
+      solaris::matrix::translation(offset)
+  );
+  object.select<WorldTransform>()->emplaceField<WorldTransform>();
+  return entity;
+}
+
+const Matrix4f &worldOf(World &world, Entity entity) {
+  return world.get<WorldTransform>(entity)->Matrix;
+}
+
+const Matrix4f &localOf(World &world, Entity entity) {
+  return world.get<LocalTransform>(entity)->Matrix;
+}
+} // namespace
+
+TEST_CASE("Hierarchy propagates transforms", "[ecs][Hierarchy]") {
+  World world{};
+  auto shape{
+      RuntimeStruct().withMember<LocalTransform>().withMember<WorldTransform>()
+  };
+  // children in another archetype than their parents
+  auto tagged{shape.withMember<ComponentA>()};
+
+  auto root{createNode(world, shape, {1, 0, 0})};
+  auto child{createNode(world, tagged, {0, 2, 0})};
+  auto grandchild{createNode(world, shape, {0, 0, 3})};
+  auto other{createNode(world, tagged, {5, 0, 0})};
+
+  // attach in an order that leaves storage out of depth-first order
+  solaris::hierarchy::setParent(world, grandchild, child);
+  solaris::hierarchy::setParent(world, child, root);
+  solaris::hierarchy::propagateTransforms(world);
+
+  REQUIRE(worldOf(world, root) == localOf(world, root));
+  REQUIRE(
+      worldOf(world, child) == worldOf(world, root) * localOf(world, child)
+  );
+  REQUIRE(
+      worldOf(world, grandchild) ==
+      worldOf(world, child) * localOf(world, grandchild)
+  );
+  REQUIRE(worldOf(world, other) == localOf(world, other));
+
+  SECTION("rows are kept in depth-first order") {
+    for (const auto &archetype : world.archetypes()) {
+      size_t previous{0};
+      for (auto entity : archetype.entities()) {
+        auto *node{world.get<Hierarchy>(entity)};
+        if (node == nullptr)
+          continue;
+        REQUIRE(node->Order >= previous);
+        previous = node->Order;
+      }
+    }
+    REQUIRE(
+        world.get<Hierarchy>(root)->Order < world.get<Hierarchy>(child)->Order
+    );
+    REQUIRE(
+        world.get<Hierarchy>(child)->Order <
+        world.get<Hierarchy>(grandchild)->Order
+    );
+  }
+
+  SECTION("reparenting moves the subtree") {
+    solaris::hierarchy::setParent(world, child, other);
+    world.get<LocalTransform>(other)->Matrix =
+        solaris::matrix::translation(Vec3f{0, 0, -4});
+    solaris::hierarchy::propagateTransforms(world);
+
+    REQUIRE(worldOf(world, root) == localOf(world, root));
+    REQUIRE(
+        worldOf(world, child) == worldOf(world, other) * localOf(world, child)
+    );
+    REQUIRE(
+        worldOf(world, grandchild) ==
+        worldOf(world, child) * localOf(world, grandchild)
+    );
+    REQUIRE(world.get<Hierarchy>(root)->Children.empty());
+  }
+
+  SECTION("destroying a node makes its children roots") {
+    world.destroyEntity(child);
+    solaris::hierarchy::propagateTransforms(world);
+
+    REQUIRE(world.get<Hierarchy>(root)->Children.empty());
+    REQUIRE(world.get<Hierarchy>(grandchild)->Parent == solaris::NoEntity);
+    REQUIRE(worldOf(world, grandchild) == localOf(world, grandchild));
+  }
+
+  SECTION("cycles are rejected") {
+    REQUIRE_THROWS_AS(
+        solaris::hierarchy::setParent(world, root, grandchild),
+        std::invalid_argument
+    );
+    REQUIRE_THROWS_AS(
+        solaris::hierarchy::setParent(world, root, root), std::invalid_argument
+    );
+  }
+}
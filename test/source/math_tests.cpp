@@ -1,7 +1,15 @@
 #include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <concepts>
+#include <solaris/math/batch.hpp>
 #include <solaris/math/matrix.hpp>
+#include <vector>
 
 using solaris::Matrix;
+using solaris::Matrix4;
+using solaris::Matrix4f;
+using solaris::Vec3f;
+using solaris::Vec4f;
 using solaris::Vector;
 
 TEST_CASE("Matrix access", "[math][Matrix]") {
@@ -89,6 +97,47 @@ TEST_CASE("Matrix subtract", "[math][Matrix]") {
   REQUIRE(result[{1, 1}] == 0);
 }
 
+TEST_CASE("Matrix element-wise expressions", "[math][Matrix]") {
+  Vec3f position{1, 2, 3};
+  Vec3f velocity{0.5f, -1, 2};
+  Vec3f force{2, 0, -4};
+
+  // evaluated lazily, so nothing is computed until the assignment
+  auto step{position + (velocity + force * 0.5f) * 2.0f - -position};
+  STATIC_REQUIRE(!std::same_as<decltype(step), Vec3f>);
+  Vec3f next{step};
+  REQUIRE(next == Vec3f(5, 2, 6));
+  REQUIRE(step[0] == 5.0f);
+  REQUIRE(0.5f * next == Vec3f(2.5f, 1, 3));
+
+  // operands that are temporaries are held by value
+  auto moved{Vec3f(1, 1, 1) + velocity};
+  REQUIRE(Vec3f{moved} == Vec3f(1.5f, 0, 3));
+
+  // each element only reads its own operands, so aliasing is fine
+  position = velocity - position;
+  REQUIRE(position == Vec3f(-0.5f, -3, -1));
+  position += velocity * 2.0f;
+  REQUIRE(position == Vec3f(0.5f, -5, 3));
+  position -= force;
+  position *= 2.0f;
+  REQUIRE(position == Vec3f(-3, -10, 14));
+
+  REQUIRE((velocity + force).dot(Vec3f(1, 1, 1)) == -0.5f);
+  REQUIRE((force - Vec3f(2, 0, -1)).length() == 3.0f);
+
+  // expressions feeding a product are evaluated once
+  auto transform{solaris::matrix::translation<float>({1, 2, 3})};
+  Vec4f point{1, 1, 1, 1};
+  REQUIRE(-transform * (point + point) == Vec4f(-4, -6, -8, -2));
+  REQUIRE((transform + transform) * point == Vec4f(4, 6, 8, 2));
+
+  constexpr Vec3f a{1, 2, 3};
+  constexpr Vec3f b{3, 2, 1};
+  STATIC_REQUIRE(a + b == Vec3f(4, 4, 4));
+  STATIC_REQUIRE(Vec3f{-(a - b) * 2.0f} == Vec3f(4, 0, -4));
+}
+
 TEST_CASE("Matrix identity transformation", "[math][Matrix][Vector]") {
   {
     // clang-format off
@@ -124,3 +173,206 @@ TEST_CASE("Matrix linear transformation", "[math][Matrix][Vector]") {
 
   REQUIRE(transformed == Vector<float, 2>(-1, 2));
 }
+
+TEST_CASE("Matrix product", "[math][Matrix]") {
+  // clang-format off
+  Matrix<int, 2, 3> lhs{
+    1, 2, 3,
+    4, 5, 6,
+  };
+  Matrix<int, 3, 2> rhs{
+    7, 8,
+    9, 10,
+    11, 12,
+  };
+  // clang-format on
+
+  REQUIRE(lhs * rhs == Matrix<int, 2, 2>(58, 64, 139, 154));
+}
+
+TEST_CASE("Matrix4f kernels match the generic path", "[math][Matrix]") {
+  Matrix4f a{};
+  Matrix4f b{};
+  Matrix4<double> aReference{};
+  Matrix4<double> bReference{};
+  for (size_t i{0}; i < 16; ++i) {
+    a.data()[i] = float(i) - 7.5f;
+    b.data()[i] = float(i * i % 11) * 0.5f;
+    aReference.data()[i] = a.data()[i];
+    bReference.data()[i] = b.data()[i];
+  }
+
+  auto product{a * b};
+  auto productReference{aReference * bReference};
+  for (size_t i{0}; i < 16; ++i)
+    REQUIRE(product.data()[i] == float(productReference.data()[i]));
+
+  Vec4f vector{1, -2, 3, 1};
+  Vector<double, 4> vectorReference{1, -2, 3, 1};
+  auto transformed{a * vector};
+  auto transformedReference{aReference * vectorReference};
+  for (size_t i{0}; i < 4; ++i)
+    REQUIRE(transformed[i] == float(transformedReference[i]));
+
+  REQUIRE(a + b - b == a);
+  REQUIRE((a * 2.0f)[{3, 3}] == 15.0f);
+}
+
+TEST_CASE("Vec3f products and normalization", "[math][Vector]") {
+  Vec3f x{1, 0, 0};
+  Vec3f y{0, 1, 0};
+
+  REQUIRE(x.cross(y) == Vec3f(0, 0, 1));
+  REQUIRE(y.cross(x) == Vec3f(0, 0, -1));
+  REQUIRE(x.dot(y) == 0.0f);
+
+  Vec3f v{3, 0, 4};
+  REQUIRE(v.length() == 5.0f);
+  auto unit{v.normalized()};
+  REQUIRE(std::abs(unit.x() - 0.6f) < 1e-6f);
+  REQUIRE(std::abs(unit.z() - 0.8f) < 1e-6f);
+
+  Vec4f w{1, 2, 3, 4};
+  REQUIRE(w.w() == 4.0f);
+  REQUIRE(w.dot(w) == 30.0f);
+}
+
+TEST_CASE("Batched transforms match single transforms", "[math][batch]") {
+  namespace batch = solaris::batch;
+  namespace matrix = solaris::matrix;
+
+  auto transform{
+      matrix::translation<float>({1, 2, 3}) * matrix::scale<float>(2.0f)
+  };
+
+  constexpr size_t count{11};
+  std::vector<Vec4f> vectors(count);
+  std::vector<Matrix4f> locals(count);
+  std::vector<float> x(count), y(count), z(count);
+  for (size_t i{0}; i < count; ++i) {
+    auto value{float(i)};
+    vectors[i] = {value, -value, 0.5f * value, 1.0f};
+    locals[i] = matrix::translation<float>({value, 0, 0});
+    x[i] = value;
+    y[i] = -value;
+    z[i] = 0.5f * value;
+  }
+
+  std::vector<Vec4f> transformed(count);
+  batch::transform(transform, vectors, transformed);
+  for (size_t i{0}; i < count; ++i)
+    REQUIRE(transformed[i] == transform * vectors[i]);
+
+  std::vector<Matrix4f> parents(count);
+  for (size_t i{0}; i < count; ++i) {
+    parents[i] = matrix::translation<float>({0, float(i), 2}) *
+                 matrix::scale<float>(float(i + 1));
+  }
+  std::vector<Matrix4f> world(count);
+  batch::multiply(parents, locals, world);
+  batch::transform(world, vectors, transformed);
+  for (size_t i{0}; i < count; ++i) {
+    REQUIRE(world[i] == parents[i] * locals[i]);
+    REQUIRE(transformed[i] == world[i] * vectors[i]);
+  }
+
+  // in place, over either input
+  auto inPlace{locals};
+  batch::multiply(parents, inPlace, inPlace);
+  REQUIRE(inPlace == world);
+  inPlace = parents;
+  batch::multiply(inPlace, locals, inPlace);
+  REQUIRE(inPlace == world);
+  auto inPlaceVectors{vectors};
+  batch::transform(world, inPlaceVectors, inPlaceVectors);
+  REQUIRE(inPlaceVectors == transformed);
+
+  batch::transformPoints(transform, {x, y, z});
+  for (size_t i{0}; i < count; ++i) {
+    auto expected{transform * vectors[i]};
+    REQUIRE(x[i] == expected.x());
+    REQUIRE(y[i] == expected.y());
+    REQUIRE(z[i] == expected.z());
+  }
+}
+
+namespace {
+bool approximately(const Matrix4f &a, const Matrix4f &b) {
+  for (size_t i{0}; i < 16; ++i) {
+    if (std::abs(a.data()[i] - b.data()[i]) > 1e-5f)
+      return false;
+  }
+  return true;
+}
+
+bool approximately(const Vec4f &a, const Vec4f &b) {
+  for (size_t i{0}; i < 4; ++i) {
+    if (std::abs(a[i] - b[i]) > 1e-5f)
+      return false;
+  }
+  return true;
+}
+} // namespace
+
+TEST_CASE("Matrix in constant expressions", "[math][Matrix]") {
+  namespace matrix = solaris::matrix;
+
+  constexpr auto translation{matrix::translation<float>({1, 2, 3})};
+  constexpr auto transform{translation * matrix::scale<float>(2.0f)};
+
+  STATIC_REQUIRE(transform * Vec4f(1, 1, 1, 1) == Vec4f(3, 4, 5, 1));
+  STATIC_REQUIRE(transform.transpose().transpose() == transform);
+  STATIC_REQUIRE(transform.affineInverse() * transform ==
+                 matrix::identity<float, 4>());
+  STATIC_REQUIRE(translation.inverse() ==
+                 matrix::translation<float>({-1, -2, -3}));
+  STATIC_REQUIRE(Vec3f(1, 0, 0).cross(Vec3f(0, 1, 0)) == Vec3f(0, 0, 1));
+}
+
+TEST_CASE("Matrix inverse and transpose", "[math][Matrix]") {
+  namespace matrix = solaris::matrix;
+
+  auto affine{
+      matrix::translation<float>({4, -2, 1}) *
+      matrix::rotation<float>({1, 2, 3}, 0.7f) *
+      matrix::scale<float>({2, 3, 0.5f})
+  };
+  auto identity{matrix::identity<float, 4>()};
+
+  REQUIRE(approximately(affine * affine.inverse(), identity));
+  REQUIRE(approximately(affine.affineInverse(), affine.inverse()));
+
+  // clang-format off
+  Matrix4f general{
+    2, 0, 1, 3,
+    1, 1, 0, 2,
+    0, 4, 1, 1,
+    1, 0, 2, 1,
+  };
+  // clang-format on
+  REQUIRE(approximately(general.inverse() * general, identity));
+  REQUIRE(general.transpose().transpose() == general);
+  REQUIRE(general.transpose()[{0, 1}] == general[{1, 0}]);
+}
+
+TEST_CASE("Projection and view builders", "[math][Matrix]") {
+  namespace matrix = solaris::matrix;
+
+  auto quarterTurn{matrix::rotation<float>({0, 0, 1}, std::acos(-1.0f) / 2)};
+  REQUIRE(approximately(quarterTurn * Vec4f(1, 0, 0, 1), Vec4f(0, 1, 0, 1)));
+
+  auto view{matrix::lookAt<float>({0, 0, 5}, {0, 0, 0}, {0, 1, 0})};
+  REQUIRE(approximately(view * Vec4f(0, 0, 5, 1), Vec4f(0, 0, 0, 1)));
+  REQUIRE(approximately(view * Vec4f(0, 0, 0, 1), Vec4f(0, 0, -5, 1)));
+
+  auto perspective{matrix::perspective(1.0f, 2.0f, 1.0f, 10.0f)};
+  auto nearPoint{perspective * Vec4f(0, 0, -1, 1)};
+  auto farPoint{perspective * Vec4f(0, 0, -10, 1)};
+  REQUIRE(std::abs(nearPoint.z() / nearPoint.w() + 1) < 1e-5f);
+  REQUIRE(std::abs(farPoint.z() / farPoint.w() - 1) < 1e-5f);
+
+  auto orthographic{matrix::orthographic(-4.0f, 4.0f, -2.0f, 2.0f, 1.0f, 3.0f)};
+  REQUIRE(approximately(
+      orthographic * Vec4f(4, -2, -3, 1), Vec4f(1, -1, 1, 1)
+  ));
+}
@@ -0,0 +1,91 @@
+#include <catch2/catch_test_macros.hpp>
+#include <solaris/framework/ecs.hpp>
+#include <solaris/framework/prefab.hpp>
+#include <vector>
+
+#include "test_components.hpp"
+
+using solaris::Entity;
+using solaris::Prefab;
+using solaris::RawObjectPtr;
+using solaris::World;
+
+namespace {
+struct Health {
+  int Points;
+};
+} // namespace
+
+TEST_CASE("Prefab instances copy the prototype", "[ecs][Prefab]") {
+  World world{};
+  auto prefab{Prefab::of(Health{100}, ComponentA{7})};
+  prefab.prototype().select<Health>()->getField<Health>().Points = 120;
+
+  // enough instances to take several doubling copies
+  auto enemies{world.instantiate(prefab, 1000)};
+  REQUIRE(enemies.size() == 1000);
+  for (auto enemy : enemies) {
+    REQUIRE(world.get<Health>(enemy)->Points == 120);
+    REQUIRE(world.get<ComponentA>(enemy)->value == 7);
+  }
+
+  world.get<Health>(enemies[3])->Points = 1;
+  REQUIRE(world.get<Health>(enemies[4])->Points == 120);
+  auto prototype{prefab.prototype().select<Health>()};
+  REQUIRE(prototype->getField<Health>().Points == 120);
+}
+
+TEST_CASE("Prefab instances with overrides", "[ecs][Prefab]") {
+  World world{};
+  auto prefab{Prefab::of(ComponentC{"grunt"}, ComponentA{0})};
+  auto &byValue{world.addIndex<ComponentA>([](const ComponentA &a) {
+    return a.value;
+  })};
+
+  auto units{world.instantiate(prefab, 5, [](Entity, RawObjectPtr object) {
+    static int next{0};
+    object.select<ComponentA>()->getField<ComponentA>().value = next++;
+  })};
+
+  for (size_t i{0}; i < units.size(); ++i) {
+    REQUIRE(world.get<ComponentC>(units[i])->value == "grunt");
+    REQUIRE(byValue.findOne(static_cast<int>(i)) == units[i]);
+  }
+
+  SECTION("entities can serve as prototypes") {
+    world.get<ComponentC>(units[2])->value = "captain";
+    auto captain{world.prefabOf(units[2])};
+    auto copies{world.instantiate(captain, 2)};
+    REQUIRE(world.get<ComponentC>(copies[0])->value == "captain");
+    REQUIRE(world.get<ComponentC>(copies[1])->value == "captain");
+    REQUIRE(byValue.count(2) == 3);
+  }
+}
+
+TEST_CASE("Prefab overrides may add components", "[ecs][Prefab]") {
+  World world{};
+  auto prefab{Prefab::of(ComponentA{1})};
+  auto &byValue{world.addIndex<ComponentA>([](const ComponentA &a) {
+    return a.value;
+  })};
+
+  // each addition creates an archetype, moving the existing ones
+  int next{0};
+  auto units{world.instantiate(prefab, 6, [&](Entity entity, RawObjectPtr) {
+    ++next;
+    if (next % 2 == 0)
+      world.add<ComponentB>(entity, static_cast<long double>(next));
+    if (next == 4)
+      world.add<ComponentC>(entity, "fourth");
+    world.get<ComponentA>(entity)->value = 10 * next;
+  })};
+
+  for (size_t i{0}; i < units.size(); ++i) {
+    auto value{10 * static_cast<int>(i + 1)};
+    REQUIRE(world.get<ComponentA>(units[i])->value == value);
+    REQUIRE(byValue.findOne(value) == units[i]);
+    REQUIRE((world.get<ComponentB>(units[i]) != nullptr) == (i % 2 == 1));
+  }
+  REQUIRE(world.get<ComponentC>(units[3])->value == "fourth");
+  REQUIRE(byValue.count(1) == 0);
+}
@@ -0,0 +1,139 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <random>
+#include <solaris/math/batch.hpp>
+#include <solaris/math/quaternion.hpp>
+#include <vector>
+
+using solaris::DualQuatf;
+using solaris::Matrix4f;
+using solaris::Quatf;
+using solaris::Vec3f;
+using solaris::Vec4f;
+namespace matrix = solaris::matrix;
+namespace quaternion = solaris::quaternion;
+
+namespace {
+constexpr float Tolerance{1e-5f};
+
+bool approximately(const Vec3f &a, const Vec3f &b) {
+  return (a - b).length() < Tolerance;
+}
+
+bool approximately(
+    const Quatf &a, const Quatf &b, float tolerance = Tolerance
+) {
+  return (a - b).length() < tolerance;
+}
+
+bool approximately(const Matrix4f &a, const Matrix4f &b) {
+  for (size_t i{0}; i < 16; ++i) {
+    if (std::abs(a.data()[i] - b.data()[i]) > Tolerance)
+      return false;
+  }
+  return true;
+}
+
+Quatf randomRotation(std::mt19937 &random) {
+  std::normal_distribution<float> normal{};
+  return Quatf{normal(random), normal(random), normal(random), normal(random)}
+      .normalized();
+}
+} // namespace
+
+TEST_CASE("Quat rotations match rotation matrices", "[math][Quat]") {
+  Vec3f axis{1, 2, 3};
+  auto rotation{Quatf::fromAxisAngle(axis, 0.9f)};
+  auto expected{matrix::rotation(axis, 0.9f)};
+
+  REQUIRE(approximately(rotation.toMatrix(), expected));
+  REQUIRE(approximately(Quatf::fromMatrix(expected), rotation));
+
+  Vec3f point{4, -1, 2};
+  auto rotated{expected * Vec4f(point.x(), point.y(), point.z(), 1)};
+  Vec3f expectedPoint{rotated.x(), rotated.y(), rotated.z()};
+  REQUIRE(approximately(rotation.rotate(point), expectedPoint));
+
+  auto twice{rotation * rotation};
+  REQUIRE(approximately(twice.toMatrix(), expected * expected));
+  REQUIRE(approximately(rotation * rotation.inverse(), Quatf{}));
+
+  // every branch of the matrix conversion
+  std::mt19937 random{7};
+  for (int i{0}; i < 100; ++i) {
+    auto q{randomRotation(random)};
+    auto converted{Quatf::fromMatrix(q.toMatrix())};
+    REQUIRE((approximately(converted, q) || approximately(converted, -q)));
+  }
+}
+
+TEST_CASE("Quat interpolation", "[math][Quat]") {
+  auto from{Quatf::fromAxisAngle({0, 0, 1}, 0.0f)};
+  auto to{Quatf::fromAxisAngle({0, 0, 1}, 2.0f)};
+
+  REQUIRE(approximately(
+      quaternion::slerp(from, to, 0.25f), Quatf::fromAxisAngle({0, 0, 1}, 0.5f)
+  ));
+  REQUIRE(approximately(
+      quaternion::slerp(from, -to, 0.5f), Quatf::fromAxisAngle({0, 0, 1}, 1.0f)
+  ));
+  REQUIRE(approximately(
+      quaternion::nlerp(from, to, 0.5f), Quatf::fromAxisAngle({0, 0, 1}, 1.0f)
+  ));
+}
+
+TEST_CASE("Batched slerp matches slerp", "[math][batch]") {
+  std::mt19937 random{42};
+  std::uniform_real_distribution<float> unit{0.0f, 1.0f};
+
+  constexpr size_t count{103};
+  std::vector<Quatf> from(count), to(count), blended(count);
+  std::vector<float> t(count);
+  for (size_t i{0}; i < count; ++i) {
+    from[i] = randomRotation(random);
+    to[i] = randomRotation(random);
+    t[i] = unit(random);
+  }
+
+  // the batched version estimates the slerp weights
+  constexpr float tolerance{1e-4f};
+
+  solaris::batch::slerp(from, to, t, blended);
+  for (size_t i{0}; i < count; ++i) {
+    auto expected{quaternion::slerp(from[i], to[i], t[i])};
+    REQUIRE(approximately(blended[i], expected, tolerance));
+  }
+
+  solaris::batch::slerp(from, to, 0.3f, blended);
+  for (size_t i{0}; i < count; ++i) {
+    auto expected{quaternion::slerp(from[i], to[i], 0.3f)};
+    REQUIRE(approximately(blended[i], expected, tolerance));
+  }
+}
+
+TEST_CASE("DualQuat rigid transforms", "[math][DualQuat]") {
+  auto rotation{Quatf::fromAxisAngle({0, 1, 0}, 1.2f)};
+  Vec3f translation{3, -1, 2};
+  auto transform{DualQuatf::fromRotationTranslation(rotation, translation)};
+
+  auto expected{
+      matrix::translation(translation) *
+      matrix::rotation<float>({0, 1, 0}, 1.2f)
+  };
+  REQUIRE(approximately(transform.toMatrix(), expected));
+  REQUIRE(approximately(transform.translation(), translation));
+  REQUIRE(approximately(DualQuatf::fromMatrix(expected).toMatrix(), expected));
+
+  Vec3f point{1, 2, 3};
+  auto moved{expected * Vec4f(1, 2, 3, 1)};
+  Vec3f expectedPoint{moved.x(), moved.y(), moved.z()};
+  REQUIRE(approximately(transform.transformPoint(point), expectedPoint));
+
+  auto composed{transform * transform};
+  REQUIRE(approximately(composed.toMatrix(), expected * expected));
+
+  std::vector<DualQuatf> bones{transform, transform};
+  std::vector<float> weights{0.25f, 0.75f};
+  auto blended{quaternion::blend<float>(bones, weights)};
+  REQUIRE(approximately(blended.toMatrix(), expected));
+}
@@ -0,0 +1,320 @@
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <memory>
+#include <solaris/core/bus.hpp>
+#include <solaris/core/queue.hpp>
+#include <solaris/core/static_bus.hpp>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using solaris::core::Bus;
+using solaris::core::Dispatcher;
+using solaris::core::Queue;
+using solaris::core::StaticBus;
+
+namespace {
+struct Received {
+  std::vector<int> Values;
+  std::vector<int> Large;
+};
+
+struct ValueEvent {
+  int value;
+};
+
+struct LargeEvent {
+  std::array<int, 16 * 1024> values;
+};
+
+struct TrackedEvent {
+  int *destroyed;
+
+  explicit TrackedEvent(int *d) : destroyed{d} {}
+  TrackedEvent(const TrackedEvent &) = delete;
+  ~TrackedEvent() { ++*destroyed; }
+};
+
+Bus<Received> receivingBus() {
+  Bus<Received> bus{};
+  bus.addHandler<ValueEvent>([](Dispatcher<ValueEvent, Received>::Context c) {
+    c->Values.push_back(c.event().value);
+  });
+  bus.addHandler<LargeEvent>([](Dispatcher<LargeEvent, Received>::Context c) {
+    c->Large.push_back(c.event().values.back());
+  });
+  return bus;
+}
+} // namespace
+
+TEST_CASE("Queue dispatches in enqueue order", "[core][Queue]") {
+  auto bus{receivingBus()};
+  Received received{};
+
+  Queue<Received> queue{};
+  for (int i{0}; i < 5000; ++i)
+    queue.enqueue<ValueEvent>(i);
+  queue.dispatchOn(bus, received);
+
+  REQUIRE(received.Values.size() == 5000);
+  for (int i{0}; i < 5000; ++i)
+    REQUIRE(received.Values[i] == i);
+
+  queue.dispatchOn(bus, received);
+  REQUIRE(received.Values.size() == 5000);
+}
+
+TEST_CASE("Queue dispatches on a StaticBus", "[core][Queue]") {
+  using Static = StaticBus<Received, ValueEvent>;
+  Static bus{};
+  bus.addHandler<ValueEvent>([](Dispatcher<ValueEvent, Received>::Context c) {
+    c->Values.push_back(c.event().value);
+  });
+  Received received{};
+
+  Queue<Received, Static> queue{};
+  queue.enqueue<ValueEvent>(1);
+  queue.enqueue<ValueEvent>(2);
+  queue.dispatchOn(bus, received);
+  queue.enqueue<ValueEvent>(3);
+  queue.dispatchBatchedOn(bus, received);
+
+  REQUIRE(received.Values == std::vector{1, 2, 3});
+}
+
+TEST_CASE("Queue handles events larger than a segment", "[core][Queue]") {
+  auto bus{receivingBus()};
+  Received received{};
+
+  Queue<Received> queue{};
+  LargeEvent large{};
+  large.values.back() = 42;
+  queue.enqueue<ValueEvent>(1);
+  queue.enqueue<LargeEvent>(large);
+  queue.enqueue<ValueEvent>(2);
+  queue.dispatchOn(bus, received);
+
+  REQUIRE(received.Values == std::vector{1, 2});
+  REQUIRE(received.Large == std::vector{42});
+}
+
+TEST_CASE("Queue destroys dispatched and discarded events", "[core][Queue]") {
+  Bus<Received> bus{};
+  Received received{};
+  int destroyed{0};
+
+  {
+    Queue<Received> queue{};
+    queue.enqueue<TrackedEvent>(&destroyed);
+    queue.dispatchOn(bus, received);
+    REQUIRE(destroyed == 1);
+
+    queue.enqueue<TrackedEvent>(&destroyed);
+    queue.enqueue<TrackedEvent>(&destroyed);
+  }
+  REQUIRE(destroyed == 3);
+}
+
+TEST_CASE("Queue accepts events from many producers", "[core][Queue]") {
+  auto bus{receivingBus()};
+  Received received{};
+
+  constexpr int producers{4};
+  constexpr int perProducer{20000};
+
+  Queue<Received> queue{};
+  std::vector<std::thread> threads;
+  for (int p{0}; p < producers; ++p) {
+    threads.emplace_back([&queue, p] {
+      for (int i{0}; i < perProducer; ++i)
+        queue.enqueue<ValueEvent>(p * perProducer + i);
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  queue.dispatchOn(bus, received);
+  REQUIRE(received.Values.size() == producers * perProducer);
+
+  // events from a single producer keep their relative order
+  std::array<int, producers> last{};
+  last.fill(-1);
+  for (auto value : received.Values) {
+    auto producer{value / perProducer};
+    REQUIRE(value > last[producer]);
+    last[producer] = value;
+  }
+}
+
+TEST_CASE("Queue producers rotate over many queues", "[core][Queue]") {
+  auto bus{receivingBus()};
+
+  // more queues than a producer could once keep segments for
+  constexpr int queues{6};
+  std::vector<std::unique_ptr<Queue<Received>>> targets;
+  for (int q{0}; q < queues; ++q)
+    targets.push_back(std::make_unique<Queue<Received>>());
+  for (int i{0}; i < 1000; ++i)
+    targets[i % queues]->enqueue<ValueEvent>(i);
+
+  for (int q{0}; q < queues; ++q) {
+    Received received{};
+    targets[q]->dispatchOn(bus, received);
+    REQUIRE(received.Values.size() == 1000 / queues + (q < 1000 % queues));
+    for (size_t i{0}; i < received.Values.size(); ++i)
+      REQUIRE(received.Values[i] == q + static_cast<int>(i) * queues);
+  }
+
+  // replacing queues drops the segments of the destroyed ones
+  targets[0]->enqueue<ValueEvent>(1);
+  targets[0] = std::make_unique<Queue<Received>>();
+  targets[0]->enqueue<ValueEvent>(2);
+  Received received{};
+  targets[0]->dispatchOn(bus, received);
+  REQUIRE(received.Values == std::vector{2});
+}
+
+TEST_CASE("Queue batched dispatch groups events by type", "[core][Queue]") {
+  struct Log {
+    std::vector<std::string> Entries;
+  };
+  struct A {
+    int value;
+  };
+  struct B {
+    int value;
+  };
+
+  Bus<Log> bus{};
+  bus.addBatchHandler<A>([](Dispatcher<A, Log>::Batch batch) {
+    std::string entry{"A"};
+    for (const auto &event : batch)
+      entry += std::to_string(event.value);
+    batch->Entries.push_back(entry);
+  });
+  bus.addHandler<B>([](Dispatcher<B, Log>::Context c) {
+    c->Entries.push_back("B" + std::to_string(c.event().value));
+  });
+
+  Queue<Log> queue{};
+  auto enqueueAll{[&] {
+    queue.enqueue<A>(1);
+    queue.enqueue<A>(2);
+    queue.enqueue<B>(1);
+    queue.enqueue<A>(3);
+    queue.enqueue<B>(2);
+  }};
+
+  SECTION("grouped by type") {
+    Log log{};
+    enqueueAll();
+    queue.dispatchBatchedOn(bus, log);
+    REQUIRE(log.Entries == std::vector<std::string>{"A123", "B1", "B2"});
+  }
+
+  SECTION("preserving global order") {
+    Log log{};
+    enqueueAll();
+    queue.dispatchBatchedOn(bus, log, solaris::core::BatchOrder::Preserve);
+    REQUIRE(
+        log.Entries == std::vector<std::string>{"A12", "B1", "A3", "B2"}
+    );
+  }
+
+  SECTION("single dispatch is a batch of one") {
+    Log log{};
+    enqueueAll();
+    queue.dispatchOn(bus, log);
+    REQUIRE(
+        log.Entries ==
+        std::vector<std::string>{"A1", "A2", "B1", "A3", "B2"}
+    );
+  }
+}
+
+TEST_CASE("Queue coalesces high-frequency events", "[core][Queue]") {
+  struct Log {
+    std::vector<std::string> Entries;
+  };
+  struct Resize {
+    int width;
+  };
+  struct Scroll {
+    int delta;
+  };
+  struct Dirty {
+    int entity;
+  };
+  struct Other {};
+  struct Boom {};
+
+  Bus<Log> bus{};
+  bus.addHandler<Boom>([](Dispatcher<Boom, Log>::Context) {
+    throw std::runtime_error("boom");
+  });
+  bus.addHandler<Resize>([](Dispatcher<Resize, Log>::Context c) {
+    c->Entries.push_back("resize " + std::to_string(c.event().width));
+  });
+  bus.addHandler<Scroll>([](Dispatcher<Scroll, Log>::Context c) {
+    c->Entries.push_back("scroll " + std::to_string(c.event().delta));
+  });
+  bus.addHandler<Dirty>([](Dispatcher<Dirty, Log>::Context c) {
+    c->Entries.push_back("dirty " + std::to_string(c.event().entity));
+  });
+  bus.addHandler<Other>([](Dispatcher<Other, Log>::Context c) {
+    c->Entries.push_back("other");
+  });
+
+  Queue<Log> queue{};
+  queue.coalesceLatest<Resize>();
+  queue.coalesceWith<Scroll>([](Scroll &pending, Scroll &&incoming) {
+    pending.delta += incoming.delta;
+  });
+  queue.dedupeBy<Dirty>([](const Dirty &dirty) { return dirty.entity; });
+
+  auto enqueueAll{[&] {
+    queue.enqueue<Resize>(100);
+    queue.enqueue<Scroll>(1);
+    queue.enqueue<Dirty>(7);
+    queue.enqueue<Other>();
+    queue.enqueue<Resize>(200);
+    queue.enqueue<Scroll>(2);
+    queue.enqueue<Dirty>(8);
+    queue.enqueue<Dirty>(7);
+    queue.enqueue<Resize>(300);
+    queue.enqueue<Scroll>(3);
+  }};
+  std::vector<std::string> expected{
+      "resize 300",
+      "scroll 6",
+      "dirty 7",
+      "other",
+      "dirty 8",
+  };
+
+  Log log{};
+  enqueueAll();
+  queue.dispatchOn(bus, log);
+  REQUIRE(log.Entries == expected);
+
+  log.Entries.clear();
+  enqueueAll();
+  queue.dispatchBatchedOn(bus, log, solaris::core::BatchOrder::Preserve);
+  REQUIRE(log.Entries == expected);
+
+  // a throwing handler leaves the events after it pending, still coalesced
+  log.Entries.clear();
+  queue.enqueue<Boom>();
+  queue.enqueue<Dirty>(7);
+  queue.enqueue<Scroll>(1);
+  REQUIRE_THROWS_AS(
+      queue.dispatchBatchedOn(bus, log, solaris::core::BatchOrder::Preserve),
+      std::runtime_error
+  );
+  REQUIRE(log.Entries.empty());
+  queue.enqueue<Dirty>(7);
+  queue.enqueue<Scroll>(2);
+  queue.dispatchOn(bus, log);
+  REQUIRE(log.Entries == std::vector<std::string>{"dirty 7", "scroll 3"});
+}
@@ -0,0 +1,45 @@
+#include <catch2/catch_test_macros.hpp>
+#include <solaris/framework/resources.hpp>
+#include <string>
+#include <typeinfo>
+#include <utility>
+
+using solaris::framework::ResourceOwners;
+using solaris::framework::Resources;
+
+namespace {
+struct Counter {
+  int Value{0};
+};
+
+struct Name {
+  std::string Value;
+};
+
+struct Missing {};
+} // namespace
+
+TEST_CASE("Resources looks up resources by type", "[framework][Resources]") {
+  auto owners{ResourceOwners<>{}.withResource<Counter>(3).withResource<Name>(
+      "solaris"
+  )};
+  Resources &resources{owners};
+
+  REQUIRE(resources.get<Counter>().Value == 3);
+  REQUIRE(resources.get<Name>().Value == "solaris");
+  REQUIRE(&resources.get<Counter>() == &owners.get<Counter>());
+
+  REQUIRE(resources.tryGet<Missing>() == nullptr);
+  REQUIRE(owners.tryGet<Missing>() == nullptr);
+  REQUIRE_THROWS_AS(resources.get<Missing>(), std::bad_cast);
+}
+
+TEST_CASE("Resources follow their owner when moved", "[framework][Resources]") {
+  ResourceOwners<Counter> first{Counter{1}};
+  auto second{std::move(first)};
+  second.get<Counter>().Value = 2;
+
+  Resources &resources{second};
+  REQUIRE(resources.tryGet<Counter>() == &second.get<Counter>());
+  REQUIRE(resources.get<Counter>().Value == 2);
+}
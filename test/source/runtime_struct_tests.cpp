@@ -11,6 +11,8 @@ TEST_CASE("RuntimeField attributes", "[ecs][RuntimeStruct][RuntimeField]") {
 
   REQUIRE(field.Size == sizeof(Moveable));
   REQUIRE(field.Alignment == alignof(Moveable));
+  REQUIRE_FALSE(field.TriviallyCopyable);
+  REQUIRE(RuntimeField::runtimeFieldFor<ComponentA>().TriviallyCopyable);
 }
 
 TEST_CASE("RuntimeField copy", "[ecs][RuntimeStruct][RuntimeField]") {
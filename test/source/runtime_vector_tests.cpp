@@ -1,4 +1,5 @@
 #include <catch2/catch_test_macros.hpp>
+#include <memory>
 #include <solaris/framework/runtime_vector.hpp>
 
 #include "test_components.hpp"
@@ -79,3 +80,42 @@ TEST_CASE("RuntimeVector dynamic allocation", "[ecs][RuntimeVector]") {
     REQUIRE(obj->getField<ComponentA>().value == 16 + i);
   }
 }
+
+TEST_CASE("RuntimeVector destroys its objects", "[ecs][RuntimeVector]") {
+  auto owner{std::make_shared<int>(0)};
+  struct Holder {
+    std::shared_ptr<int> value;
+  };
+
+  {
+    RuntimeVector vector{RuntimeStruct().withMember<Holder>()};
+    for (int i{0}; i < 3; ++i)
+      vector.pushBack().select<Holder>()->emplaceField<Holder>(owner);
+    REQUIRE(owner.use_count() == 4);
+
+    auto moved{std::move(vector)};
+    REQUIRE(vector.size() == 0);
+    REQUIRE(owner.use_count() == 4);
+
+    moved.clear();
+    REQUIRE(owner.use_count() == 1);
+    moved.pushBack().select<Holder>()->emplaceField<Holder>(owner);
+    REQUIRE(owner.use_count() == 2);
+  }
+  REQUIRE(owner.use_count() == 1);
+}
+
+TEST_CASE("RuntimeVector swaps within its capacity", "[ecs][RuntimeVector]") {
+  RuntimeVector vector{RuntimeStruct().withMember<ComponentA>()};
+  for (int i{0}; i < 3; ++i)
+    vector.pushBack().select<ComponentA>()->emplaceField<ComponentA>(i);
+  vector.shrinkToFit();
+  REQUIRE(vector.capacity() == 3);
+
+  vector.swap(0, 2);
+  vector.swap(1, 2);
+  REQUIRE(vector.capacity() == 3);
+  REQUIRE(vector[0].select<ComponentA>()->getField<ComponentA>().value == 2);
+  REQUIRE(vector[1].select<ComponentA>()->getField<ComponentA>().value == 0);
+  REQUIRE(vector[2].select<ComponentA>()->getField<ComponentA>().value == 1);
+}
@@ -0,0 +1,141 @@
+#include <catch2/catch_test_macros.hpp>
+#include <limits>
+#include <random>
+#include <solaris/core/bus.hpp>
+#include <solaris/core/scheduled_queue.hpp>
+#include <solaris/core/static_bus.hpp>
+#include <solaris/core/timing_wheel.hpp>
+#include <string>
+#include <vector>
+
+using solaris::core::Bus;
+using solaris::core::Dispatcher;
+using solaris::core::ScheduledQueue;
+using solaris::core::StaticBus;
+using solaris::core::TimingWheel;
+
+TEST_CASE("TimingWheel expires values in due order", "[core][TimingWheel]") {
+  TimingWheel<int> wheel{};
+
+  std::mt19937_64 random{1234};
+  std::vector<uint64_t> dues;
+  for (int i{0}; i < 100000; ++i) {
+    // spread over several wheel levels
+    auto due{random() % (uint64_t{1} << (6 * (1 + i % 4)))};
+    dues.push_back(due);
+    wheel.insert(due, i);
+  }
+  REQUIRE(wheel.size() == dues.size());
+
+  std::vector<int> expired;
+  uint64_t last{0};
+  for (uint64_t tick : {0u, 1u, 63u, 64u, 5000u, 300000u, 20000000u}) {
+    wheel.advanceTo(tick, [&](uint64_t due, int value) {
+      REQUIRE(due <= tick);
+      REQUIRE(due >= last);
+      REQUIRE(dues[value] == due);
+      last = due;
+      expired.push_back(value);
+    });
+    REQUIRE(wheel.now() == tick);
+  }
+
+  REQUIRE(expired.size() == dues.size());
+  REQUIRE(wheel.empty());
+}
+
+TEST_CASE("TimingWheel skips ahead to far due ticks", "[core][TimingWheel]") {
+  TimingWheel<int> wheel{1000};
+  wheel.insert(uint64_t{1} << 50, 1);
+  wheel.insert(999, 2);
+
+  std::vector<int> expired;
+  auto collect{[&](uint64_t, int value) { expired.push_back(value); }};
+
+  wheel.advanceTo(1000, collect);
+  REQUIRE(expired == std::vector{2});
+
+  wheel.advanceTo((uint64_t{1} << 50) - 1, collect);
+  REQUIRE(expired == std::vector{2});
+
+  wheel.advanceTo(uint64_t{1} << 50, collect);
+  REQUIRE(expired == std::vector{2, 1});
+}
+
+TEST_CASE("TimingWheel advances to the last tick", "[core][TimingWheel]") {
+  constexpr auto last{std::numeric_limits<uint64_t>::max()};
+  std::vector<int> expired;
+  auto collect{[&](uint64_t, int value) { expired.push_back(value); }};
+
+  TimingWheel<int> empty{};
+  empty.advanceTo(last, collect);
+  REQUIRE(empty.now() == last);
+
+  TimingWheel<int> wheel{};
+  wheel.insert(last, 1);
+  wheel.insert(last - 1, 2);
+  wheel.advanceTo(last, collect);
+  REQUIRE(expired == std::vector{2, 1});
+  REQUIRE(wheel.empty());
+  REQUIRE(wheel.now() == last);
+}
+
+TEST_CASE("ScheduledQueue dispatches due events", "[core][ScheduledQueue]") {
+  struct Log {
+    std::vector<std::string> Entries;
+  };
+  struct Timer {
+    std::string name;
+  };
+
+  Bus<Log> bus{};
+  bus.addHandler<Timer>([](Dispatcher<Timer, Log>::Context context) {
+    context->Entries.push_back(context.event().name);
+  });
+
+  Log log{};
+  ScheduledQueue<Log> queue{};
+  queue.schedule<Timer>({.Delay = 10}, "late");
+  queue.schedule<Timer>({.Delay = 2, .Priority = 0}, "low");
+  queue.schedule<Timer>({.Delay = 2, .Priority = 5}, "high");
+  queue.enqueue<Timer>("now");
+
+  queue.dispatchOn(bus, log);
+  REQUIRE(log.Entries == std::vector<std::string>{"now"});
+
+  queue.advance(5);
+  queue.dispatchOn(bus, log);
+  REQUIRE(log.Entries == std::vector<std::string>{"now", "high", "low"});
+
+  queue.advanceTo(9);
+  queue.dispatchOn(bus, log);
+  REQUIRE(log.Entries.size() == 3);
+
+  queue.advanceTo(10);
+  queue.dispatchOn(bus, log);
+  REQUIRE(log.Entries.back() == "late");
+  REQUIRE(queue.size() == 0);
+}
+
+TEST_CASE(
+    "ScheduledQueue dispatches on a StaticBus",
+    "[core][ScheduledQueue]"
+) {
+  struct Count {
+    int Fired{0};
+  };
+  struct Tick {};
+
+  StaticBus<Count, Tick> bus{};
+  bus.addHandler<Tick>([](Dispatcher<Tick, Count>::Context c) { ++c->Fired; });
+
+  Count count{};
+  ScheduledQueue<Count, StaticBus<Count, Tick>> queue{};
+  queue.schedule<Tick>({.Delay = 1});
+  queue.enqueue<Tick>();
+  queue.dispatchOn(bus, count);
+  REQUIRE(count.Fired == 1);
+  queue.advance();
+  queue.dispatchOn(bus, count);
+  REQUIRE(count.Fired == 2);
+}
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <solaris/framework/spatial_index.hpp>
+#include <vector>
+
+using solaris::Bounds;
+using solaris::Bvh;
+using solaris::Entity;
+using solaris::Ray;
+using solaris::RuntimeStruct;
+using solaris::SpatialIndex;
+using solaris::UniformGrid;
+using solaris::Vec3f;
+using solaris::World;
+
+namespace {
+struct Body {
+  Vec3f Position;
+};
+
+struct Tracked {
+  Entity Id;
+  Body *Component;
+};
+
+std::vector<Tracked> createBodies(World &world, size_t count) {
+  std::mt19937 random{7};
+  std::uniform_real_distribution<float> coordinate{-20.0f, 20.0f};
+  auto shape{RuntimeStruct().withMember<Body>()};
+
+  std::vector<Entity> entities;
+  for (size_t i{0}; i < count; ++i) {
+    auto [entity, object]{world.createEntity(shape)};
+    object.select<Body>()->emplaceField<Body>(Vec3f{
+        coordinate(random),
+        coordinate(random),
+        coordinate(random),
+    });
+    entities.push_back(entity);
+  }
+
+  // storage may have moved while creating, so look the components up after
+  std::vector<Tracked> bodies;
+  for (auto entity : entities) {
+    auto object{world.getEntity(entity).select<Body>()};
+    bodies.push_back({entity, &object->getField<Body>()});
+  }
+  return bodies;
+}
+
+template <typename F>
+std::vector<Entity> bruteForce(const std::vector<Tracked> &bodies, F &&keep) {
+  std::vector<Entity> output;
+  for (const auto &body : bodies) {
+    if (keep(body.Component->Position))
+      output.push_back(body.Id);
+  }
+  std::ranges::sort(output);
+  return output;
+}
+
+std::vector<Entity> sorted(std::vector<Entity> entities) {
+  std::ranges::sort(entities);
+  return entities;
+}
+
+template <typename S>
+void checkQueries(SpatialIndex<Body, S, Vec3f Body::*> &index) {
+  World world{};
+  auto bodies{createBodies(world, 500)};
+  index.update(world);
+  REQUIRE(index.size() == bodies.size());
+
+  auto checkAll{[&] {
+    Bounds bounds{{-5, -8, 0}, {6, 2, 9}};
+    REQUIRE(
+        sorted(index.box(bounds)) ==
+        bruteForce(bodies, [&](const Vec3f &p) { return bounds.contains(p); })
+    );
+
+    Vec3f center{3, -1, 2};
+    REQUIRE(
+        sorted(index.sphere(center, 7.5f)) ==
+        bruteForce(bodies, [&](const Vec3f &p) {
+          return Vec3f{p - center}.length() <= 7.5f;
+        })
+    );
+
+    Ray ray{{-25, 0, 0}, {1, 0.1f, 0}};
+    auto hits{index.raycast(ray, 60.0f, 3.0f)};
+    Vec3f direction{ray.Direction.normalized()};
+    auto along{[&](Entity entity) {
+      auto body{std::ranges::find(bodies, entity, &Tracked::Id)};
+      return Vec3f{body->Component->Position - ray.Origin}.dot(direction);
+    }};
+    REQUIRE(std::ranges::is_sorted(hits, {}, along));
+    REQUIRE(
+        sorted(hits) == bruteForce(bodies, [&](const Vec3f &p) {
+          Vec3f offset{p - ray.Origin};
+          auto t{std::clamp(offset.dot(direction), 0.0f, 60.0f)};
+          return Vec3f{offset - direction * t}.length() <= 3.0f;
+        })
+    );
+    // rays far longer than the occupied region stop at its far side
+    for (auto length : {1e8f, std::numeric_limits<float>::infinity()}) {
+      REQUIRE(
+          sorted(index.raycast(ray, length, 3.0f)) ==
+          bruteForce(bodies, [&](const Vec3f &p) {
+            Vec3f offset{p - ray.Origin};
+            auto t{std::max(offset.dot(direction), 0.0f)};
+            return Vec3f{offset - direction * t}.length() <= 3.0f;
+          })
+      );
+    }
+
+    Vec3f point{1, 2, 3};
+    auto nearest{index.nearest(point, 10)};
+    REQUIRE(nearest.size() == 10);
+    auto distance{[&](Entity entity) {
+      auto body{std::ranges::find(bodies, entity, &Tracked::Id)};
+      return Vec3f{body->Component->Position - point}.length();
+    }};
+    REQUIRE(std::ranges::is_sorted(nearest, {}, distance));
+    auto farthest{distance(nearest.back())};
+    REQUIRE(
+        bruteForce(bodies, [&](const Vec3f &p) {
+          return Vec3f{p - point}.length() < farthest;
+        }).size() < 10
+    );
+  }};
+  checkAll();
+
+  // update() catches up with the bodies that moved
+  for (size_t i{0}; i < bodies.size(); i += 7)
+    bodies[i].Component->Position += Vec3f{3.5f, -2, 1};
+  index.update(world);
+  checkAll();
+
+  // or with only the bodies that are known to have moved
+  std::vector<Entity> changed;
+  for (size_t i{3}; i < bodies.size(); i += 11) {
+    bodies[i].Component->Position += Vec3f{-1, 4, -2};
+    changed.push_back(bodies[i].Id);
+  }
+  index.update(world, changed);
+  checkAll();
+
+  index.remove(bodies.front().Id);
+  bodies.erase(bodies.begin());
+  checkAll();
+
+  index.set(bodies.front().Id, {100, 100, 100});
+  REQUIRE(index.box({{99, 99, 99}, {101, 101, 101}}) ==
+          std::vector<Entity>{bodies.front().Id});
+}
+} // namespace
+
+TEST_CASE("SpatialIndex queries match brute force", "[ecs][spatial]") {
+  SECTION("Uniform grid") {
+    SpatialIndex<Body, UniformGrid, Vec3f Body::*> index{
+        UniformGrid{4.0f}, &Body::Position
+    };
+    checkQueries(index);
+  }
+  SECTION("Bounding volume hierarchy") {
+    SpatialIndex<Body, Bvh, Vec3f Body::*> index{Bvh{}, &Body::Position};
+    checkQueries(index);
+  }
+}
+
+TEST_CASE("SpatialIndex forgets missing entities", "[ecs][spatial]") {
+  World world{};
+  auto shape{RuntimeStruct().withMember<Vec3f>()};
+  auto [entity, object]{world.createEntity(shape)};
+  object.select<Vec3f>()->emplaceField<Vec3f>(1.0f, 2.0f, 3.0f);
+
+  SpatialIndex<Vec3f> index{};
+  index.update(world);
+  REQUIRE(index.nearest({0, 0, 0}, 5) == std::vector<Entity>{entity});
+
+  SECTION("when rescanning the world") {
+    World empty{};
+    index.update(empty);
+    REQUIRE(index.size() == 0);
+    REQUIRE(index.nearest({0, 0, 0}, 5).empty());
+  }
+
+  SECTION("when told the entity changed") {
+    world.destroyEntity(entity);
+    index.update(world, std::vector<Entity>{entity});
+    REQUIRE(index.size() == 0);
+    REQUIRE(index.raycast({{0, 0, 0}, {1, 2, 3}}, 10.0f).empty());
+  }
+}
+
+TEST_CASE("SpatialIndex moves a lone entity across cells", "[ecs][spatial]") {
+  SpatialIndex<Body, UniformGrid, Vec3f Body::*> index{
+      UniformGrid{4.0f}, &Body::Position
+  };
+  Entity entity{1};
+  index.set(entity, {1, 1, 1});
+  index.set(entity, {30, 1, 1});
+
+  REQUIRE(index.size() == 1);
+  REQUIRE(
+      index.raycast({{0, 1, 1}, {1, 0, 0}}, 50.0f, 0.5f) ==
+      std::vector<Entity>{entity}
+  );
+  REQUIRE(index.nearest({0, 0, 0}, 1) == std::vector<Entity>{entity});
+}
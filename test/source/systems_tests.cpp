@@ -0,0 +1,105 @@
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <solaris/core/thread_pool.hpp>
+#include <solaris/framework/resources.hpp>
+#include <solaris/framework/systems.hpp>
+#include <stdexcept>
+#include <vector>
+
+using solaris::core::ThreadPool;
+using solaris::framework::Read;
+using solaris::framework::ResourceOwners;
+using solaris::framework::Resources;
+using solaris::framework::SystemScheduler;
+using solaris::framework::Write;
+
+namespace {
+struct Input {
+  int Presses{0};
+};
+
+struct Physics {
+  int Steps{0};
+};
+
+struct Audio {
+  int Sounds{0};
+};
+} // namespace
+
+TEST_CASE("ThreadPool runs every index once", "[core][ThreadPool]") {
+  ThreadPool pool{4};
+  std::vector<std::atomic<int>> calls(1000);
+
+  pool.parallelFor(calls.size(), [&](size_t index) { ++calls[index]; });
+  for (auto &count : calls)
+    REQUIRE(count == 1);
+
+  REQUIRE_THROWS_AS(
+      pool.parallelFor(
+          8,
+          [](size_t index) {
+            if (index == 5)
+              throw std::runtime_error("failed");
+          }
+      ),
+      std::runtime_error
+  );
+}
+
+#if SOLARIS_CHECK_BORROWS
+TEST_CASE("Conflicting borrows are detected", "[framework][Resources]") {
+  ResourceOwners<Input, Physics> owners{Input{}, Physics{}};
+  Resources &resources{owners};
+
+  {
+    auto first{resources.read<Input>()};
+    auto second{resources.read<Input>()};
+    REQUIRE_THROWS_AS(resources.write<Input>(), std::logic_error);
+    auto physics{resources.write<Physics>()};
+    physics->Steps = first->Presses + second->Presses + 1;
+  }
+
+  auto input{resources.write<Input>()};
+  REQUIRE_THROWS_AS(resources.read<Input>(), std::logic_error);
+  REQUIRE(resources.read<Physics>()->Steps == 1);
+}
+#endif
+
+TEST_CASE(
+    "SystemScheduler runs conflicting systems in order",
+    "[framework][SystemScheduler]"
+) {
+  ResourceOwners<Input, Physics, Audio> resources{Input{}, Physics{}, Audio{}};
+
+  SystemScheduler scheduler{};
+  scheduler.addSystem<Write<Input>>([](Input &input) { ++input.Presses; });
+  scheduler.addSystem<Read<Input>, Write<Physics>>(
+      [](const Input &input, Physics &physics) {
+        physics.Steps += input.Presses;
+      }
+  );
+  scheduler.addSystem<Read<Input>, Write<Audio>>(
+      [](const Input &input, Audio &audio) { audio.Sounds += input.Presses; }
+  );
+  // does not commute with the addition above, so the order shows
+  scheduler.addSystem<Write<Physics>>([](Physics &physics) {
+    physics.Steps = physics.Steps * 3 % 1009;
+  });
+
+  REQUIRE(
+      scheduler.stages() == std::vector<std::vector<size_t>>{{0}, {1, 2}, {3}}
+  );
+
+  ThreadPool pool{2};
+  for (int frame{0}; frame < 100; ++frame)
+    scheduler.run(resources, pool);
+  scheduler.run(resources);
+
+  int steps{0};
+  for (int presses{1}; presses <= 101; ++presses)
+    steps = (steps + presses) * 3 % 1009;
+  REQUIRE(resources.get<Input>().Presses == 101);
+  REQUIRE(resources.get<Physics>().Steps == steps);
+  REQUIRE(resources.get<Audio>().Sounds == 101 * 102 / 2);
+}